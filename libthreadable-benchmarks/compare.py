@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Compares two benchmark result files written by threadable-benchmarks with
+THREADABLE_BENCH_OUTPUT=<path> (the '<path>.json' files).
+
+Benchmarks are matched by title & name. A change is flagged when the median
+time per unit differs by more than --threshold and the per-epoch timings
+differ significantly (two-sided Mann-Whitney U test, --alpha).
+
+Exits with 1 if any benchmark regressed.
+
+  THREADABLE_BENCH_OUTPUT=before threadable-benchmarks
+  THREADABLE_BENCH_OUTPUT=after threadable-benchmarks
+  ./compare.py before.json after.json
+"""
+
+import argparse
+import json
+import math
+import statistics
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)["results"]
+    timings = {}
+    for r in results:
+        # elapsed is per iteration, each iteration being 'batch' units
+        batch = r["batch"] or 1
+        timings[(r["title"], r["name"])] = (
+            r["unit"],
+            [m["elapsed"] / batch for m in r["measurements"]],
+        )
+    return timings
+
+
+def mann_whitney_p(a, b):
+    """Two-sided p-value using the normal approximation (tie corrected)."""
+    n1, n2 = len(a), len(b)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    values = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+    ranks = [0.0] * len(values)
+    ties = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        t = j - i + 1
+        ties += t**3 - t
+        i = j + 1
+    r1 = sum(rank for rank, (_, group) in zip(ranks, values) if group == 0)
+    u = r1 - n1 * (n1 + 1) / 2
+    n = n1 + n2
+    sigma = math.sqrt(n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1))))
+    if sigma == 0:
+        return 1.0
+    z = (abs(u - n1 * n2 / 2) - 0.5) / sigma
+    return math.erfc(max(z, 0) / math.sqrt(2))
+
+
+def format_time(seconds):
+    for unit, scale in (("s", 1), ("ms", 1e-3), ("us", 1e-6)):
+        if seconds >= scale:
+            return f"{seconds / scale:.3g}{unit}"
+    return f"{seconds / 1e-9:.3g}ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0].strip())
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument(
+        "--threshold", type=float, default=0.05, help="min relative change (default: 0.05)"
+    )
+    parser.add_argument(
+        "--alpha", type=float, default=0.01, help="significance level (default: 0.01)"
+    )
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+
+    regressions = 0
+    rows = []
+    for key in after:
+        if key not in before:
+            continue
+        unit, old = before[key]
+        _, new = after[key]
+        old_median = statistics.median(old)
+        new_median = statistics.median(new)
+        change = new_median / old_median - 1 if old_median > 0 else 0.0
+        p = mann_whitney_p(old, new)
+        verdict = ""
+        if abs(change) > args.threshold and p < args.alpha:
+            verdict = "REGRESSION" if change > 0 else "improvement"
+            regressions += change > 0
+        rows.append(
+            (
+                f"{key[0]} | {key[1]}",
+                f"{format_time(old_median)}/{unit}",
+                f"{format_time(new_median)}/{unit}",
+                f"{change:+.1%}",
+                f"{p:.3f}",
+                verdict,
+            )
+        )
+
+    header = ("benchmark", "before", "after", "change", "p", "")
+    widths = [max(len(row[i]) for row in rows + [header]) for i in range(len(header))]
+    for row in [header] + rows:
+        print("  ".join(col.ljust(width) for col, width in zip(row, widths)).rstrip())
+
+    missing = [f"{t} | {n}" for t, n in before if (t, n) not in after]
+    for name in missing:
+        print(f"missing in '{args.after}': {name}")
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,460 @@
+#include <threadable-benchmarks/util.hxx>
+#include <threadable/pool.hxx>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<tbb/task_arena.h>) && __has_include(<tbb/task_group.h>)
+  #include <tbb/task_arena.h>
+  #include <tbb/task_group.h>
+  #define THREADABLE_BENCH_TBB
+#endif
+
+#include <doctest/doctest.h>
+
+#include <nanobench.h>
+
+namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
+
+/*
+  The same workloads run on threadable::pool, TBB (when available) and a
+  naive mutex + condition variable pool, for every pool size.
+
+  Each runner provides:
+    run(root)      - runs 'root' on a pool thread & waits for it, jobs may be
+                     posted from it
+    post(job)      - fire & forget, also from within jobs
+    wait()         - waits for everything posted
+    invoke(a, b)   - runs 'a' & 'b' in parallel (fork-join), from within jobs
+*/
+namespace
+{
+  constexpr auto fib_n           = 27;
+  constexpr auto fib_cutoff      = 14; // computed serially below this
+  constexpr auto for_size        = std::size_t{1} << 22;
+  constexpr auto for_chunks      = std::size_t{256};
+  constexpr auto fan_out_jobs    = std::size_t{1} << 14;
+  constexpr auto pipeline_items  = std::size_t{1} << 12;
+  constexpr auto pipeline_stages = 3;
+
+  // tracks posted jobs that haven't finished yet
+  class pending_jobs
+  {
+  public:
+    void
+    add() noexcept
+    {
+      count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void
+    done() noexcept
+    {
+      if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        count_.notify_all();
+      }
+    }
+
+    void
+    wait() const noexcept
+    {
+      for (auto n = count_.load(std::memory_order_acquire); n != 0;
+           n      = count_.load(std::memory_order_acquire))
+      {
+        count_.wait(n, std::memory_order_acquire);
+      }
+    }
+
+  private:
+    std::atomic_size_t count_{0};
+  };
+
+  class threadable_runner
+  {
+  public:
+    explicit threadable_runner(std::size_t threads)
+      : pool_(static_cast<unsigned int>(threads))
+      , queue_(pool_.create())
+    {}
+
+    void
+    run(auto&& root)
+    {
+      queue_.push(root).wait();
+    }
+
+    void
+    post(auto job)
+    {
+      pending_.add();
+      queue_.push(
+        [this, job]
+        {
+          job();
+          pending_.done();
+        });
+    }
+
+    void
+    wait()
+    {
+      pending_.wait();
+    }
+
+    void
+    invoke(auto&& a, auto&& b)
+    {
+      auto token = pool_.spawn(a);
+      b();
+      token.wait();
+    }
+
+  private:
+    threadable::pool<1 << 16> pool_;
+    decltype(pool_)::queue_t& queue_;
+    pending_jobs                      pending_;
+  };
+
+#ifdef THREADABLE_BENCH_TBB
+  class tbb_runner
+  {
+  public:
+    explicit tbb_runner(std::size_t threads)
+      : arena_(static_cast<int>(threads))
+    {}
+
+    void
+    run(auto&& root)
+    {
+      arena_.execute(root);
+    }
+
+    void
+    post(auto job)
+    {
+      group_.run(job);
+    }
+
+    void
+    wait()
+    {
+      arena_.execute(
+        [this]
+        {
+          group_.wait();
+        });
+    }
+
+    void
+    invoke(auto&& a, auto&& b)
+    {
+      tbb::task_group group;
+      group.run(a);
+      b();
+      group.wait();
+    }
+
+  private:
+    tbb::task_arena arena_;
+    tbb::task_group group_;
+  };
+#endif
+
+  // Single queue guarded by a mutex. Threads waiting for a job to finish run
+  // other pending jobs meanwhile, otherwise fork-join would deadlock.
+  class naive_runner
+  {
+  public:
+    explicit naive_runner(std::size_t threads)
+    {
+      for (std::size_t i = 0; i < threads; ++i)
+      {
+        threads_.emplace_back(
+          [this]
+          {
+            while (true)
+            {
+              auto lock = std::unique_lock{mutex_};
+              cond_.wait(lock,
+                         [this]
+                         {
+                           return quit_ || !jobs_.empty();
+                         });
+              if (jobs_.empty())
+              {
+                break;
+              }
+              auto job = std::move(jobs_.front());
+              jobs_.pop_front();
+              lock.unlock();
+              job();
+            }
+          });
+      }
+    }
+
+    naive_runner(naive_runner const&) = delete;
+    naive_runner(naive_runner&&)      = delete;
+
+    ~naive_runner()
+    {
+      {
+        auto _ = std::scoped_lock{mutex_};
+        quit_  = true;
+      }
+      cond_.notify_all();
+      for (auto& thread : threads_)
+      {
+        thread.join();
+      }
+    }
+
+    auto operator=(naive_runner const&) -> naive_runner& = delete;
+    auto operator=(naive_runner&&) -> naive_runner&      = delete;
+
+    // (also waits for anything posted meanwhile)
+    void
+    run(auto&& root)
+    {
+      post(root);
+      wait();
+    }
+
+    void
+    post(auto job)
+    {
+      pending_.add();
+      push(
+        [this, job]
+        {
+          job();
+          pending_.done();
+        });
+    }
+
+    void
+    wait()
+    {
+      pending_.wait();
+    }
+
+    void
+    invoke(auto&& a, auto&& b)
+    {
+      auto done = std::atomic_bool{false};
+      push(
+        [&a, &done]
+        {
+          a();
+          done.store(true, std::memory_order_release);
+        });
+      b();
+      while (!done.load(std::memory_order_acquire))
+      {
+        if (!try_execute())
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+
+  private:
+    void
+    push(std::function<void()> job)
+    {
+      {
+        auto _ = std::scoped_lock{mutex_};
+        jobs_.push_back(std::move(job));
+      }
+      cond_.notify_one();
+    }
+
+    auto
+    try_execute() -> bool
+    {
+      auto lock = std::unique_lock{mutex_};
+      if (jobs_.empty())
+      {
+        return false;
+      }
+      auto job = std::move(jobs_.front());
+      jobs_.pop_front();
+      lock.unlock();
+      job();
+      return true;
+    }
+
+    std::mutex                        mutex_;
+    std::condition_variable           cond_;
+    std::deque<std::function<void()>> jobs_;
+    bool                              quit_ = false;
+    pending_jobs                      pending_;
+    std::vector<std::thread>          threads_;
+  };
+
+  auto
+  fib_serial(int n) -> int
+  {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+  }
+
+  auto
+  fib(auto& runner, int n) -> int
+  {
+    if (n < fib_cutoff)
+    {
+      return fib_serial(n);
+    }
+    int x = 0;
+    int y = 0;
+    runner.invoke(
+      [&runner, &x, n]
+      {
+        x = fib(runner, n - 1);
+      },
+      [&runner, &y, n]
+      {
+        y = fib(runner, n - 2);
+      });
+    return x + y;
+  }
+
+  // an item passes its value on to the next stage
+  template<typename runner_t>
+  struct pipeline_stage
+  {
+    void
+    operator()() const
+    {
+      auto       in  = value;
+      auto const out = utils::do_trivial_work(in);
+      bench::doNotOptimizeAway(out);
+      if (stage + 1 < pipeline_stages)
+      {
+        runner->post(pipeline_stage{runner, stage + 1, out});
+      }
+    }
+
+    runner_t* runner;
+    int       stage;
+    int       value;
+  };
+
+  template<typename runner_t>
+  void
+  bench_workloads(std::string const& name, std::size_t threads, bench::Bench& fibBench,
+                  bench::Bench& forBench, bench::Bench& fanOutBench, bench::Bench& pipelineBench)
+  {
+    auto runner = runner_t(threads);
+
+    utils::measure(fibBench, name,
+                   [&]
+                   {
+                     runner.run(
+                       [&]
+                       {
+                         bench::doNotOptimizeAway(fib(runner, fib_n));
+                       });
+                   });
+
+    auto data = std::vector<float>(for_size, 1.0f);
+    utils::measure(forBench, name,
+                   [&]
+                   {
+                     runner.run(
+                       [&]
+                       {
+                         for (std::size_t c = 0; c < for_chunks; ++c)
+                         {
+                           runner.post(
+                             [&data, c]
+                             {
+                               auto const size = for_size / for_chunks;
+                               for (auto i = c * size; i < (c + 1) * size; ++i)
+                               {
+                                 data[i] = data[i] * 0.5f + 1.0f;
+                               }
+                             });
+                         }
+                       });
+                     runner.wait();
+                   });
+    bench::doNotOptimizeAway(data);
+
+    utils::measure(fanOutBench, name,
+                   [&]
+                   {
+                     runner.run(
+                       [&]
+                       {
+                         for (std::size_t i = 0; i < fan_out_jobs; ++i)
+                         {
+                           runner.post(
+                             []
+                             {
+                               auto val = 1;
+                               bench::doNotOptimizeAway(utils::do_non_trivial_work(val));
+                             });
+                         }
+                       });
+                     runner.wait();
+                   });
+
+    utils::measure(pipelineBench, name,
+                   [&]
+                   {
+                     runner.run(
+                       [&]
+                       {
+                         for (std::size_t i = 0; i < pipeline_items; ++i)
+                         {
+                           runner.post(pipeline_stage<runner_t>{&runner, 0, 1});
+                         }
+                       });
+                     runner.wait();
+                   });
+  }
+}
+
+TEST_CASE("comparison: threadable vs tbb vs naive pool")
+{
+  for (auto threads : utils::pool_sizes())
+  {
+    auto const suffix = " (" + std::to_string(threads) + " threads)";
+
+    bench::Bench fibBench;
+    fibBench.warmup(1).relative(true).unit("fib");
+    fibBench.title("fib(" + std::to_string(fib_n) + ")" + suffix);
+
+    bench::Bench forBench;
+    forBench.warmup(1).relative(true).batch(for_size).unit("element");
+    forBench.title("parallel for" + suffix);
+
+    bench::Bench fanOutBench;
+    fanOutBench.warmup(1).relative(true).batch(fan_out_jobs).unit("job");
+    fanOutBench.title("fan-out/fan-in" + suffix);
+
+    bench::Bench pipelineBench;
+    pipelineBench.warmup(1).relative(true).batch(pipeline_items).unit("item");
+    pipelineBench.title("pipeline (" + std::to_string(pipeline_stages) + " stages)" + suffix);
+
+    // the first one is the baseline ('relative')
+    bench_workloads<naive_runner>("mutex + condvar pool", threads, fibBench, forBench,
+                                  fanOutBench, pipelineBench);
+    bench_workloads<threadable_runner>("threadable::pool", threads, fibBench, forBench,
+                                       fanOutBench, pipelineBench);
+#ifdef THREADABLE_BENCH_TBB
+    bench_workloads<tbb_runner>("tbb::task_group", threads, fibBench, forBench, fanOutBench,
+                                pipelineBench);
+#endif
+  }
+}
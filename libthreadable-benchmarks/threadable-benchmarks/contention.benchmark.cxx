@@ -0,0 +1,219 @@
+#include <threadable-benchmarks/util.hxx>
+#include <threadable/histogram.hxx>
+#include <threadable/pool.hxx>
+#include <threadable/queue.hxx>
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <nanobench.h>
+
+namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
+
+namespace
+{
+  constexpr auto jobs_per_iteration = 1 << 16;
+  constexpr auto latency_sample     = 64; // time every n:th push
+  auto           val                = 1;  // NOLINT
+
+  using trivial_job_t = decltype(
+    []()
+    {
+      bench::doNotOptimizeAway(val = utils::do_trivial_work(val));
+    });
+  using non_trivial_job_t = decltype(
+    []()
+    {
+      bench::doNotOptimizeAway(val = utils::do_non_trivial_work(val));
+    });
+
+  // pushes 'n' jobs, timing a sample of them
+  template<typename job_t>
+  void
+  push(auto& queue, std::size_t n, threadable::histogram& latency, threadable::token_group& group)
+  {
+    using clk_t = std::chrono::steady_clock;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      if (i % latency_sample == 0) [[unlikely]]
+      {
+        auto const begin = clk_t::now();
+        group += queue.push(job_t{});
+        latency.record(clk_t::now() - begin);
+      }
+      else
+      {
+        group += queue.push(job_t{});
+      }
+    }
+  }
+
+  void
+  print_latency(std::string const& name, threadable::histogram const& latency)
+  {
+    std::cout << "push latency (" << name << "): ";
+    latency.write_text(std::cout);
+    std::cout << '\n';
+  }
+
+  // 'producers' threads push to a single queue drained by one consumer (a
+  // full queue is a precondition violation, so they push max_size() in total)
+  template<std::size_t capacity, typename job_t,
+           threadable::producer kind = threadable::producer::multi>
+  void
+  bench_queue(bench::Bench& b, std::size_t producers)
+  {
+    using queue_t = threadable::queue<capacity, kind>;
+
+    auto       queue       = queue_t(threadable::execution_policy::sequential);
+    auto const perProducer = queue.max_size() / producers;
+    auto       latency     = threadable::histogram{};
+    auto const name        = std::to_string(producers) + " producer(s), capacity " +
+                             std::to_string(capacity) +
+                             (kind == threadable::producer::single ? " (spsc)" : "");
+
+    b.batch(perProducer * producers);
+    utils::measure(b, name,
+                   [&]
+                   {
+                     auto start     = std::latch(static_cast<std::ptrdiff_t>(producers + 1));
+                     auto latencies = std::vector<threadable::histogram>(producers);
+                     auto threads   = std::vector<std::thread>{};
+                     for (std::size_t p = 0; p < producers; ++p)
+                     {
+                       threads.emplace_back(
+                         [&, p]
+                         {
+                           start.arrive_and_wait();
+                           // completion is tracked by the consumer counting executed jobs
+                           auto group = threadable::token_group{};
+                           push<job_t>(queue, perProducer, latencies[p], group);
+                         });
+                     }
+                     start.arrive_and_wait();
+                     for (std::size_t executed = 0; executed < perProducer * producers;)
+                     {
+                       executed += queue.execute();
+                     }
+                     for (std::size_t p = 0; p < producers; ++p)
+                     {
+                       threads[p].join();
+                       latency.merge(latencies[p]);
+                     }
+                   });
+    print_latency(name, latency);
+  }
+
+  // 'producers' threads push to a single queue & wait for their jobs
+  template<typename job_t>
+  void
+  bench_pool(bench::Bench& b, std::size_t workers, std::size_t producers)
+  {
+    auto  pool        = threadable::pool<jobs_per_iteration>(static_cast<unsigned int>(workers));
+    auto& queue       = pool.create();
+    auto  perProducer = queue.max_size() / producers;
+    auto  latency     = threadable::histogram{};
+    auto  name =
+      std::to_string(producers) + " producer(s), " + std::to_string(workers) + " worker(s)";
+
+    b.batch(perProducer * producers);
+    utils::measure(b, name,
+                   [&]
+                   {
+                     auto start     = std::latch(static_cast<std::ptrdiff_t>(producers));
+                     auto latencies = std::vector<threadable::histogram>(producers);
+                     auto threads   = std::vector<std::thread>{};
+                     for (std::size_t p = 0; p < producers; ++p)
+                     {
+                       threads.emplace_back(
+                         [&, p]
+                         {
+                           start.arrive_and_wait();
+                           auto group = threadable::token_group{};
+                           push<job_t>(queue, perProducer, latencies[p], group);
+                           group.wait();
+                         });
+                     }
+                     for (std::size_t p = 0; p < producers; ++p)
+                     {
+                       threads[p].join();
+                       latency.merge(latencies[p]);
+                     }
+                   });
+    print_latency(name, latency);
+  }
+
+  template<typename job_t>
+  void
+  queue_matrix(bench::Bench& b, std::string const& jobs)
+  {
+    b.title("queue: push (contended, " + jobs + ")");
+    for (auto producers : utils::thread_counts())
+    {
+      bench_queue<1 << 12, job_t>(b, producers);
+      bench_queue<1 << 16, job_t>(b, producers);
+    }
+  }
+
+  // the same single producer pushing to a multi & single producer queue
+  template<typename job_t>
+  void
+  single_producer_matrix(bench::Bench& b, std::string const& jobs)
+  {
+    b.title("queue: push (single producer, " + jobs + ")");
+    bench_queue<1 << 12, job_t>(b, 1);
+    bench_queue<1 << 12, job_t, threadable::producer::single>(b, 1);
+    bench_queue<1 << 16, job_t>(b, 1);
+    bench_queue<1 << 16, job_t, threadable::producer::single>(b, 1);
+  }
+
+  template<typename job_t>
+  void
+  pool_matrix(bench::Bench& b, std::string const& jobs)
+  {
+    for (auto workers : utils::pool_sizes())
+    {
+      b.title("pool: push & wait (contended, " + jobs + ", " + std::to_string(workers) +
+              " workers)");
+      for (auto producers : utils::thread_counts())
+      {
+        bench_pool<job_t>(b, workers, producers);
+      }
+    }
+  }
+}
+
+TEST_CASE("queue: push (contended)")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).unit("job");
+
+  queue_matrix<trivial_job_t>(b, "trivial");
+  queue_matrix<non_trivial_job_t>(b, "non-trivial");
+}
+
+TEST_CASE("queue: push (single producer)")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).unit("job");
+
+  single_producer_matrix<trivial_job_t>(b, "trivial");
+  single_producer_matrix<non_trivial_job_t>(b, "non-trivial");
+}
+
+TEST_CASE("pool: push & wait (contended)")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).unit("job");
+
+  pool_matrix<trivial_job_t>(b, "trivial");
+  pool_matrix<non_trivial_job_t>(b, "non-trivial");
+}
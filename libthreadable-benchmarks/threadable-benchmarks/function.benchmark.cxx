@@ -8,6 +8,7 @@
 #include <nanobench.h>
 
 namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
 
 namespace
 {
@@ -18,63 +19,64 @@ TEST_CASE("function")
 {
   bench::Bench b;
   b.warmup(1).relative(true).batch(1);
+  utils::perf_counters(b);
 
   auto lambda = []()
   {
-    bench::doNotOptimizeAway(val = threadable::utils::do_trivial_work(val));
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val));
   };
   using lambda_t = decltype(lambda);
   auto func      = threadable::function<>(lambda);
   auto funcStd   = std::function<void()>(lambda);
 
-  b.title("assign")
-    .run("lambda",
-         [&]
-         {
-           bench::doNotOptimizeAway(lambda = lambda_t{});
-         })
-    .run("std::function",
-         [&]
-         {
-           bench::doNotOptimizeAway(funcStd = lambda);
-         })
-    .run("threadable::function",
-         [&]
-         {
-           bench::doNotOptimizeAway(func = lambda);
-         });
+  b.title("assign");
+  utils::measure(b, "lambda",
+                 [&]
+                 {
+                   bench::doNotOptimizeAway(lambda = lambda_t{});
+                 });
+  utils::measure(b, "std::function",
+                 [&]
+                 {
+                   bench::doNotOptimizeAway(funcStd = lambda);
+                 });
+  utils::measure(b, "threadable::function",
+                 [&]
+                 {
+                   bench::doNotOptimizeAway(func = lambda);
+                 });
 
-  b.title("invoke")
-    .run("lambda",
-         [&]
-         {
-           lambda();
-         })
-    .run("std::function",
-         [&]
-         {
-           funcStd();
-         })
-    .run("threadable::function",
-         [&]
-         {
-           func();
-         });
+  b.title("invoke");
+  utils::measure(b, "lambda",
+                 [&]
+                 {
+                   lambda();
+                 });
+  utils::measure(b, "std::function",
+                 [&]
+                 {
+                   funcStd();
+                 });
+  utils::measure(b, "threadable::function",
+                 [&]
+                 {
+                   func();
+                 });
 
-  b.title("reset")
-    .run("lambda",
-         [&]
-         {
-           bench::doNotOptimizeAway(lambda = lambda_t{});
-         })
-    .run("std::function",
-         [&]
-         {
-           bench::doNotOptimizeAway(funcStd = nullptr);
-         })
-    .run("threadable::function",
-         [&]
-         {
-           bench::doNotOptimizeAway(func = nullptr);
-         });
+  b.title("reset");
+  utils::measure(b, "lambda",
+                 [&]
+                 {
+                   bench::doNotOptimizeAway(lambda = lambda_t{});
+                 });
+  utils::measure(b, "std::function",
+                 [&]
+                 {
+                   bench::doNotOptimizeAway(funcStd = nullptr);
+                 });
+  utils::measure(b, "threadable::function",
+                 [&]
+                 {
+                   bench::doNotOptimizeAway(func = nullptr);
+                 });
 }
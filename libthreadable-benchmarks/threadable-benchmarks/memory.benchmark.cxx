@@ -0,0 +1,111 @@
+#include <threadable-benchmarks/util.hxx>
+#include <threadable/pool.hxx>
+#include <threadable/queue.hxx>
+
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <nanobench.h>
+
+namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
+
+namespace
+{
+  void
+  print_memory(std::string const& name, std::size_t accounted, std::size_t resident)
+  {
+    constexpr auto mib = 1024.0 * 1024.0;
+    std::cout << "memory (" << name << "): " << std::fixed << std::setprecision(2)
+              << static_cast<double>(accounted) / mib << " MiB accounted, "
+              << static_cast<double>(resident) / mib << " MiB resident\n"
+              << std::defaultfloat;
+  }
+
+  // Reports 'memory_usage()' & how much the resident set grows while one is
+  // alive, then times construction & destruction.
+  template<typename make_t>
+  void
+  bench_memory(bench::Bench& b, std::string const& name, make_t&& make)
+  {
+    {
+      auto const before    = utils::resident_memory();
+      auto const instance  = make();
+      auto const resident  = utils::resident_memory();
+      auto const accounted = instance->memory_usage();
+      print_memory(name, accounted, resident > before ? resident - before : 0);
+    }
+    utils::measure(b, name,
+                   [&]
+                   {
+                     bench::doNotOptimizeAway(make().get());
+                   });
+  }
+
+  template<std::size_t capacity>
+  void
+  bench_queue(bench::Bench& b)
+  {
+    bench_memory(b, "queue<" + std::to_string(capacity) + ">",
+                 []
+                 {
+                   return std::make_unique<threadable::queue<capacity>>();
+                 });
+  }
+
+  template<std::size_t capacity>
+  void
+  bench_pool(bench::Bench& b, std::size_t workers, std::size_t queues)
+  {
+    bench_memory(b,
+                 "pool<" + std::to_string(capacity) + ">, " + std::to_string(workers) +
+                   " workers, " + std::to_string(queues) + " queues",
+                 [workers, queues]
+                 {
+                   auto pool = std::make_unique<threadable::pool<capacity>>(
+                     static_cast<unsigned int>(workers));
+                   for (std::size_t i = 0; i < queues; ++i)
+                   {
+                     (void)pool->create();
+                   }
+                   return pool;
+                 });
+  }
+}
+
+TEST_CASE("memory: queue")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).unit("queue");
+
+  b.title("construct & destroy");
+  bench_queue<1 << 8>(b);
+  bench_queue<1 << 12>(b);
+  bench_queue<1 << 16>(b);
+  bench_queue<1 << 20>(b);
+}
+
+TEST_CASE("memory: pool")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).unit("pool");
+
+  b.title("construct & destroy (by workers)");
+  for (auto workers : utils::pool_sizes())
+  {
+    bench_pool<1 << 12>(b, workers, 1);
+    bench_pool<1 << 16>(b, workers, 1);
+  }
+
+  b.title("construct & destroy (by queues)");
+  for (std::size_t queues : {1, 10, 100})
+  {
+    bench_pool<1 << 12>(b, 2, queues);
+  }
+}
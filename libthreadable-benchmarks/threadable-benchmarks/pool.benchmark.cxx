@@ -1,18 +1,43 @@
 #include <threadable-benchmarks/util.hxx>
 #include <threadable/pool.hxx>
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iostream>
 #include <queue>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <doctest/doctest.h>
 
 #include <nanobench.h>
 
 namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
 
 namespace
 {
   constexpr auto jobs_per_iteration = 1 << 20;
+  constexpr auto scaling_jobs       = 1 << 10;
   auto           val                = 1; // NOLINT
+
+  // max/mean jobs executed per worker (1 is perfectly balanced)
+  template<typename pool_t>
+  auto
+  imbalance(pool_t const& pool) -> double
+  {
+    auto const workers = pool.stats().workers;
+    auto       max     = std::size_t{0};
+    auto       total   = std::size_t{0};
+    for (auto const& w : workers)
+    {
+      max = std::max(max, w.executed);
+      total += w.executed;
+    }
+    return total ? static_cast<double>(max * workers.size()) / static_cast<double>(total) : 0.0;
+  }
 }
 
 TEST_CASE("pool: job execution")
@@ -21,40 +46,101 @@ TEST_CASE("pool: job execution")
 
   bench::Bench b;
   b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
 
   using job_t = decltype([](){
-    bench::doNotOptimizeAway(val = threadable::utils::do_non_trivial_work(val) );
+    bench::doNotOptimizeAway(val = utils::do_non_trivial_work(val) );
   });
 
   b.title("push & wait");
   {
     std::queue<job_t> queue;
-    b.run("std::queue",
-          [&]
-          {
-            for (std::size_t i = 0; i < jobs_per_iteration; ++i)
-            {
-              queue.emplace();
-            }
-            while (!queue.empty())
-            {
-              auto& job = queue.back();
-              job();
-              queue.pop();
-            }
-          });
+    utils::measure(b, "std::queue",
+                   [&]
+                   {
+                     for (std::size_t i = 0; i < jobs_per_iteration; ++i)
+                     {
+                       queue.emplace();
+                     }
+                     while (!queue.empty())
+                     {
+                       auto& job = queue.back();
+                       job();
+                       queue.pop();
+                     }
+                   });
   }
   {
     auto& queue = pool.create(threadable::execution_policy::parallel);
-    b.run("threadable::pool",
-          [&]
-          {
-            threadable::token_group group;
-            for (std::size_t i = 0; i < queue.max_size(); ++i)
-            {
-              group += queue.push(job_t{});
-            }
-            group.wait();
-          });
+    utils::measure(b, "threadable::pool",
+                   [&]
+                   {
+                     threadable::token_group group;
+                     for (std::size_t i = 0; i < queue.max_size(); ++i)
+                     {
+                       group += queue.push(job_t{});
+                     }
+                     group.wait();
+                   });
+  }
+}
+
+// Sweeps worker count (up to 2x cores) & number of registered queues, with
+// jobs spread evenly over all queues. Shows the scheduler's per-queue cost
+// and how well random dispatch spreads ranges over workers.
+TEST_CASE("pool: scalability")
+{
+  using job_t = decltype([](){
+    bench::doNotOptimizeAway(val = utils::do_non_trivial_work(val) );
+  });
+
+  for (std::size_t queues : {1, 10, 100, 1000})
+  {
+    bench::Bench b;
+    b.warmup(1).relative(true).batch(scaling_jobs).unit("job");
+    utils::perf_counters(b);
+    b.title("push & wait (" + std::to_string(queues) + " queues)");
+
+    // fewest executing threads (scheduler excluded) & their time per job
+    auto baseThreads = std::size_t{0};
+    auto baseTime    = 0.0;
+    for (auto workers : utils::pool_sizes(2 * std::thread::hardware_concurrency()))
+    {
+      auto pool = threadable::pool<scaling_jobs * 2>(static_cast<unsigned int>(workers));
+      auto qs   = std::vector<std::reference_wrapper<decltype(pool)::queue_t>>{};
+      for (std::size_t i = 0; i < queues; ++i)
+      {
+        qs.emplace_back(pool.create());
+      }
+
+      auto const name = std::to_string(workers) + " workers";
+      utils::measure(b, name,
+                     [&]
+                     {
+                       threadable::token_group group;
+                       for (std::size_t i = 0; i < scaling_jobs; ++i)
+                       {
+                         group += qs[i % queues].get().push(job_t{});
+                       }
+                       group.wait();
+                     });
+
+      auto const threads = workers - 1;
+      auto const time    = b.results().back().median(bench::Result::Measure::elapsed);
+      if (baseThreads == 0)
+      {
+        baseThreads = threads;
+        baseTime    = time;
+      }
+      auto const speedup = time > 0 ? baseTime / time : 0.0;
+      std::cout << "scaling (" << queues << " queues, " << name << "): speedup " << speedup
+                << ", efficiency "
+                << speedup * static_cast<double>(baseThreads) / static_cast<double>(threads);
+      if constexpr (threadable::details::stats_enabled)
+      {
+        std::cout << ", imbalance " << imbalance(pool);
+      }
+      std::cout << '\n';
+    }
   }
 }
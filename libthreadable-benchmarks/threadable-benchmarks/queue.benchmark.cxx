@@ -1,8 +1,10 @@
 #include <threadable-benchmarks/util.hxx>
 #include <threadable/queue.hxx>
+#include <threadable/soa_queue.hxx>
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include <doctest/doctest.h>
@@ -10,6 +12,7 @@
 #include <nanobench.h>
 
 namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
 
 namespace
 {
@@ -21,9 +24,10 @@ TEST_CASE("queue: push")
 {
   bench::Bench b;
   b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
 
   using job_t = decltype([](){
-    bench::doNotOptimizeAway(val = threadable::utils::do_trivial_work(val) );
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
   });
 
   b.title("push");
@@ -31,29 +35,29 @@ TEST_CASE("queue: push")
     auto queue = std::vector<std::function<void()>>();
     queue.reserve(jobs_per_iteration);
 
-    b.run("std::vector",
-          [&]
-          {
-            queue.clear();
-            for (std::size_t i = 0; i < jobs_per_iteration; ++i)
-            {
-              bench::doNotOptimizeAway(queue.emplace_back(job_t{}));
-            }
-          });
+    utils::measure(b, "std::vector",
+                   [&]
+                   {
+                     queue.clear();
+                     for (std::size_t i = 0; i < jobs_per_iteration; ++i)
+                     {
+                       bench::doNotOptimizeAway(queue.emplace_back(job_t{}));
+                     }
+                   });
   }
   b.title("push");
   {
     auto queue = threadable::queue<jobs_per_iteration>();
 
-    b.run("threadable::queue",
-          [&]
-          {
-            queue.clear();
-            for (std::size_t i = 0; i < queue.max_size(); ++i)
-            {
-              bench::doNotOptimizeAway(queue.push(job_t{}));
-            }
-          });
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     queue.clear();
+                     for (std::size_t i = 0; i < queue.max_size(); ++i)
+                     {
+                       bench::doNotOptimizeAway(queue.push(job_t{}));
+                     }
+                   });
   }
 }
 
@@ -61,9 +65,10 @@ TEST_CASE("queue: iterate (sequential)")
 {
   bench::Bench b;
   b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
 
   using job_t = decltype([](){
-    bench::doNotOptimizeAway(val = threadable::utils::do_trivial_work(val) );
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
   });
 
   b.title("iterate - sequential");
@@ -71,15 +76,15 @@ TEST_CASE("queue: iterate (sequential)")
     auto queue = std::vector<std::function<void()>>();
     queue.resize(jobs_per_iteration, job_t{});
 
-    b.run("std::vector",
-          [&]
-          {
-            std::for_each(std::execution::seq, std::begin(queue), std::end(queue),
-                          [](auto const& job)
-                          {
-                            bench::doNotOptimizeAway(job);
-                          });
-          });
+    utils::measure(b, "std::vector",
+                   [&]
+                   {
+                     std::for_each(std::execution::seq, std::begin(queue), std::end(queue),
+                                   [](auto const& job)
+                                   {
+                                     bench::doNotOptimizeAway(job);
+                                   });
+                   });
   }
   {
     auto queue = threadable::queue<jobs_per_iteration>();
@@ -88,15 +93,15 @@ TEST_CASE("queue: iterate (sequential)")
       queue.push(job_t{});
     }
 
-    b.run("threadable::queue",
-          [&]
-          {
-            std::for_each(std::execution::seq, std::begin(queue), std::end(queue),
-                          [](auto const& job)
-                          {
-                            bench::doNotOptimizeAway(job);
-                          });
-          });
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     std::for_each(std::execution::seq, std::begin(queue), std::end(queue),
+                                   [](auto const& job)
+                                   {
+                                     bench::doNotOptimizeAway(job);
+                                   });
+                   });
   }
 }
 
@@ -104,9 +109,10 @@ TEST_CASE("queue: iterate (parallel)")
 {
   bench::Bench b;
   b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
 
   using job_t = decltype([](){
-    bench::doNotOptimizeAway(val = threadable::utils::do_trivial_work(val) );
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
   });
 
   b.title("iterate - parallel");
@@ -114,15 +120,15 @@ TEST_CASE("queue: iterate (parallel)")
     auto queue = std::vector<std::function<void()>>();
     queue.resize(jobs_per_iteration, job_t{});
 
-    b.run("std::vector",
-          [&]
-          {
-            std::for_each(std::execution::par, std::begin(queue), std::end(queue),
-                          [](auto const& job)
-                          {
-                            bench::doNotOptimizeAway(job);
-                          });
-          });
+    utils::measure(b, "std::vector",
+                   [&]
+                   {
+                     std::for_each(std::execution::par, std::begin(queue), std::end(queue),
+                                   [](auto const& job)
+                                   {
+                                     bench::doNotOptimizeAway(job);
+                                   });
+                   });
   }
   {
     auto queue = threadable::queue<jobs_per_iteration>();
@@ -131,15 +137,15 @@ TEST_CASE("queue: iterate (parallel)")
       queue.push(job_t{});
     }
 
-    b.run("threadable::queue",
-          [&]
-          {
-            std::for_each(std::execution::par, std::begin(queue), std::end(queue),
-                          [](auto const& job)
-                          {
-                            bench::doNotOptimizeAway(job);
-                          });
-          });
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     std::for_each(std::execution::par, std::begin(queue), std::end(queue),
+                                   [](auto const& job)
+                                   {
+                                     bench::doNotOptimizeAway(job);
+                                   });
+                   });
   }
 }
 
@@ -147,9 +153,10 @@ TEST_CASE("queue: execute (sequential)")
 {
   bench::Bench b;
   b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
 
   using job_t = decltype([](){
-    bench::doNotOptimizeAway(val = threadable::utils::do_trivial_work(val) );
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
   });
 
   b.title("execute - sequential");
@@ -157,15 +164,15 @@ TEST_CASE("queue: execute (sequential)")
     auto queue = std::vector<std::function<void()>>();
     queue.resize(jobs_per_iteration, job_t{});
 
-    b.run("std::vector",
-          [&]
-          {
-            std::for_each(std::execution::seq, std::begin(queue), std::end(queue),
-                          [](auto& job)
-                          {
-                            job();
-                          });
-          });
+    utils::measure(b, "std::vector",
+                   [&]
+                   {
+                     std::for_each(std::execution::seq, std::begin(queue), std::end(queue),
+                                   [](auto& job)
+                                   {
+                                     job();
+                                   });
+                   });
   }
   {
     auto queue = threadable::queue<jobs_per_iteration>();
@@ -175,15 +182,15 @@ TEST_CASE("queue: execute (sequential)")
     }
     auto range = queue.consume();
 
-    b.run("threadable::queue",
-          [&]
-          {
-            std::for_each(std::execution::seq, std::begin(range), std::end(range),
-                          [](auto& job)
-                          {
-                            job.get()();
-                          });
-          });
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     std::for_each(std::execution::seq, std::begin(range), std::end(range),
+                                   [](auto& job)
+                                   {
+                                     job.get()();
+                                   });
+                   });
   }
 }
 
@@ -191,9 +198,10 @@ TEST_CASE("queue: execute (parallel)")
 {
   bench::Bench b;
   b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
 
   using job_t = decltype([](){
-    bench::doNotOptimizeAway(val = threadable::utils::do_trivial_work(val) );
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
   });
 
   b.title("execute - parallel");
@@ -201,15 +209,15 @@ TEST_CASE("queue: execute (parallel)")
     auto queue = std::vector<std::function<void()>>();
     queue.resize(jobs_per_iteration, job_t{});
 
-    b.run("std::vector",
-          [&]
-          {
-            std::for_each(std::execution::par, std::begin(queue), std::end(queue),
-                          [](auto& job)
-                          {
-                            job();
-                          });
-          });
+    utils::measure(b, "std::vector",
+                   [&]
+                   {
+                     std::for_each(std::execution::par, std::begin(queue), std::end(queue),
+                                   [](auto& job)
+                                   {
+                                     job();
+                                   });
+                   });
   }
   {
     auto queue = threadable::queue<jobs_per_iteration>();
@@ -219,14 +227,129 @@ TEST_CASE("queue: execute (parallel)")
     }
     auto range = queue.consume();
 
-    b.run("threadable::queue",
-          [&]
-          {
-            std::for_each(std::execution::par, std::begin(range), std::end(range),
-                          [](auto& job)
-                          {
-                            job.get()();
-                          });
-          });
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     std::for_each(std::execution::par, std::begin(range), std::end(range),
+                                   [](auto& job)
+                                   {
+                                     job.get()();
+                                   });
+                   });
+  }
+}
+
+TEST_CASE("queue: push & execute (soa layout)")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
+
+  using job_t = decltype([](){
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
+  });
+
+  b.title("push & execute - sequential");
+  {
+    auto queue = threadable::queue<jobs_per_iteration>(threadable::execution_policy::sequential);
+
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     for (std::size_t i = 0; i < queue.max_size(); ++i)
+                     {
+                       queue.push(job_t{});
+                     }
+                     bench::doNotOptimizeAway(queue.execute());
+                   });
+  }
+  {
+    auto queue = std::make_unique<threadable::soa_queue<jobs_per_iteration>>();
+
+    utils::measure(b, "threadable::soa_queue",
+                   [&]
+                   {
+                     for (std::size_t i = 0; i < queue->max_size(); ++i)
+                     {
+                       queue->push(job_t{});
+                     }
+                     bench::doNotOptimizeAway(queue->execute());
+                   });
+  }
+}
+
+TEST_CASE("queue: completion scan (soa layout)")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
+
+  using job_t = decltype([](){
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
+  });
+
+  b.title("count pending jobs");
+  {
+    auto queue = threadable::queue<jobs_per_iteration>();
+    for (std::size_t i = 0; i < queue.max_size(); ++i)
+    {
+      queue.push(job_t{});
+    }
+
+    utils::measure(b, "threadable::queue",
+                   [&]
+                   {
+                     bench::doNotOptimizeAway(std::count_if(std::begin(queue), std::end(queue),
+                                                            [](auto const& job)
+                                                            {
+                                                              return !job.done();
+                                                            }));
+                   });
+  }
+  {
+    auto queue = std::make_unique<threadable::soa_queue<jobs_per_iteration>>();
+    for (std::size_t i = 0; i < queue->max_size(); ++i)
+    {
+      queue->push(job_t{});
+    }
+
+    utils::measure(b, "threadable::soa_queue",
+                   [&]
+                   {
+                     bench::doNotOptimizeAway(queue->pending());
+                   });
+  }
+}
+
+TEST_CASE("queue: execute (huge pages)")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+  utils::perf_counters(b);
+
+  using job_t = decltype([](){
+    bench::doNotOptimizeAway(val = utils::do_trivial_work(val) );
+  });
+
+  b.title("execute - sequential (64 MiB of job slots)");
+  for (auto kind : {threadable::pages::normal, threadable::pages::huge})
+  {
+    auto queue = threadable::queue<jobs_per_iteration>(threadable::execution_policy::sequential,
+                                                       kind);
+    for (std::size_t i = 0; i < queue.max_size(); ++i)
+    {
+      queue.push(job_t{});
+    }
+    auto range = queue.consume();
+
+    utils::measure(b, kind == threadable::pages::huge ? "huge pages" : "normal pages",
+                   [&]
+                   {
+                     std::for_each(std::execution::seq, std::begin(range), std::end(range),
+                                   [](auto& job)
+                                   {
+                                     job.get()();
+                                   });
+                   });
   }
 }
@@ -0,0 +1,70 @@
+#include <threadable-benchmarks/util.hxx>
+#include <threadable/pool.hxx>
+#include <threadable/scheduling.hxx>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <nanobench.h>
+
+namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
+
+namespace
+{
+  constexpr auto jobs_per_iteration = 1 << 12;
+  auto           val                = 1; // NOLINT
+
+  // Every 4th queue gets jobs 16x as expensive as the others, so a policy
+  // ignoring load piles up work on some workers.
+  template<threadable::scheduling::policy policy_t>
+  void
+  measure(bench::Bench& b, std::string const& name, std::size_t queues)
+  {
+    auto pool = threadable::pool<jobs_per_iteration, policy_t>();
+    auto qs   = std::vector<std::reference_wrapper<typename decltype(pool)::queue_t>>{};
+    for (std::size_t i = 0; i < queues; ++i)
+    {
+      qs.emplace_back(pool.create());
+    }
+
+    utils::measure(b, name,
+                   [&]
+                   {
+                     threadable::token_group group;
+                     for (std::size_t i = 0; i < jobs_per_iteration; ++i)
+                     {
+                       auto const q = i % queues;
+                       group += qs[q].get().push(
+                         [work = q % 4 == 0 ? 16 : 1]
+                         {
+                           for (int w = 0; w < work; ++w)
+                           {
+                             bench::doNotOptimizeAway(val = utils::do_non_trivial_work(val));
+                           }
+                         });
+                     }
+                     group.wait();
+                   });
+  }
+}
+
+TEST_CASE("scheduling: policies")
+{
+  for (std::size_t queues : {4, 64})
+  {
+    bench::Bench b;
+    b.warmup(1).relative(true).batch(jobs_per_iteration).unit("job");
+    utils::perf_counters(b);
+    b.title("uneven jobs (" + std::to_string(queues) + " queues)");
+
+    measure<threadable::scheduling::random>(b, "random", queues);
+    measure<threadable::scheduling::power_of_two>(b, "power_of_two", queues);
+    measure<threadable::scheduling::round_robin>(b, "round_robin", queues);
+    measure<threadable::scheduling::least_loaded>(b, "least_loaded", queues);
+  }
+}
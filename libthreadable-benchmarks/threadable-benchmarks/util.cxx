@@ -1,5 +1,27 @@
 #include <threadable-benchmarks/util.hxx>
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+  #include <unistd.h>
+#endif
+#ifdef __GLIBC__
+  #include <malloc.h>
+#endif
+#if __has_include(<linux/perf_event.h>)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #define THREADABLE_BENCH_PERF_EVENT
+#endif
+
 namespace
 {
   auto
@@ -34,6 +56,123 @@ namespace
 
     return total;
   }
+
+  // Cache misses of the calling thread (user space only), invalid when not
+  // permitted or supported.
+  class cache_miss_counter
+  {
+  public:
+    cache_miss_counter() noexcept
+    {
+#ifdef THREADABLE_BENCH_PERF_EVENT
+      perf_event_attr attr{};
+      attr.type           = PERF_TYPE_HARDWARE;
+      attr.size           = sizeof(attr);
+      attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+      attr.disabled       = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    cache_miss_counter(cache_miss_counter const&) = delete;
+    cache_miss_counter(cache_miss_counter&&)      = delete;
+
+    ~cache_miss_counter()
+    {
+#ifdef THREADABLE_BENCH_PERF_EVENT
+      if (valid())
+      {
+        close(fd_);
+      }
+#endif
+    }
+
+    auto operator=(cache_miss_counter const&) -> cache_miss_counter& = delete;
+    auto operator=(cache_miss_counter&&) -> cache_miss_counter&      = delete;
+
+    [[nodiscard]] auto
+    valid() const noexcept -> bool
+    {
+      return fd_ != -1;
+    }
+
+    void
+    start() noexcept
+    {
+#ifdef THREADABLE_BENCH_PERF_EVENT
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    auto
+    stop() noexcept -> std::uint64_t
+    {
+      std::uint64_t count = 0;
+#ifdef THREADABLE_BENCH_PERF_EVENT
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count))
+      {
+        count = 0;
+      }
+#endif
+      return count;
+    }
+
+  private:
+    int fd_ = -1;
+  };
+
+  auto
+  cache_misses() -> cache_miss_counter&
+  {
+    thread_local cache_miss_counter counter;
+    return counter;
+  }
+
+  // Results of all benchmarks, written when exiting.
+  class results_writer
+  {
+  public:
+    explicit results_writer(std::string path)
+      : path_(std::move(path))
+    {}
+
+    results_writer(results_writer const&) = delete;
+    results_writer(results_writer&&)      = delete;
+
+    ~results_writer()
+    {
+      write(path_ + ".json", ankerl::nanobench::templates::json());
+      write(path_ + ".csv", ankerl::nanobench::templates::csv());
+    }
+
+    auto operator=(results_writer const&) -> results_writer& = delete;
+    auto operator=(results_writer&&) -> results_writer&      = delete;
+
+    void
+    add(ankerl::nanobench::Result const& result)
+    {
+      results_.push_back(result);
+    }
+
+  private:
+    void
+    write(std::string const& file, char const* format) const
+    {
+      auto os = std::ofstream(file);
+      ankerl::nanobench::render(format, results_, os);
+      if (!os)
+      {
+        std::cerr << "THREADABLE_BENCH_OUTPUT: failed to write '" << file << "'\n";
+      }
+    }
+
+    std::string                            path_;
+    std::vector<ankerl::nanobench::Result> results_;
+  };
 }
 
 namespace threadable::utils
@@ -49,4 +188,112 @@ namespace threadable::utils
   {
     return non_trivial_work(val);
   }
+
+  auto
+  thread_counts(std::size_t max) -> std::vector<std::size_t>
+  {
+    std::vector<std::size_t> counts;
+    for (std::size_t n = 1; n < max; n *= 2)
+    {
+      counts.push_back(n);
+    }
+    counts.push_back(std::max(max, std::size_t{1}));
+    return counts;
+  }
+
+  auto
+  pool_sizes(std::size_t max) -> std::vector<std::size_t>
+  {
+    auto sizes = thread_counts(std::max(std::size_t{2}, max));
+    std::erase_if(sizes,
+                  [](auto threads)
+                  {
+                    return threads < 2;
+                  });
+    return sizes;
+  }
+
+  auto
+  resident_memory() -> std::size_t
+  {
+#ifdef __GLIBC__
+    // don't count memory that's been freed but kept by malloc
+    malloc_trim(0);
+#endif
+#ifdef __linux__
+    // in pages: total size, resident, ...
+    auto        statm    = std::ifstream("/proc/self/statm");
+    std::size_t size     = 0;
+    std::size_t resident = 0;
+    if (statm >> size >> resident)
+    {
+      return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+  }
+
+  auto
+  perf_mode() -> bool
+  {
+    static auto const enabled = []
+    {
+      if (std::getenv("THREADABLE_BENCH_PERF") == nullptr)
+      {
+        return false;
+      }
+      if (!cache_misses().valid())
+      {
+        std::cerr << "THREADABLE_BENCH_PERF: performance counters not permitted or "
+                     "supported (see /proc/sys/kernel/perf_event_paranoid), timings only\n";
+        return false;
+      }
+      // (counters aren't inherited, worker threads would only be counted once
+      // they've exited)
+      std::cerr << "THREADABLE_BENCH_PERF: counters are of the benchmarking thread only, "
+                   "not of pool (or other) threads\n";
+      return true;
+    }();
+    return enabled;
+  }
+
+  void
+  perf_counters(ankerl::nanobench::Bench& b)
+  {
+    b.performanceCounters(perf_mode());
+  }
+
+  namespace details
+  {
+    void
+    start_cache_misses()
+    {
+      cache_misses().start();
+    }
+
+    void
+    report_cache_misses(ankerl::nanobench::Bench const& b, std::string const& name,
+                        std::uint64_t calls)
+    {
+      auto const misses = cache_misses().stop();
+      auto const units  = static_cast<double>(calls) * b.batch<double>();
+      std::cout << "cache misses, bench thread only (" << b.title() << ", " << name
+                << "): " << (units > 0 ? static_cast<double>(misses) / units : 0.0) << '/'
+                << b.unit() << '\n';
+    }
+
+    void
+    collect(ankerl::nanobench::Bench const& b)
+    {
+      static auto writer = results_writer(output_path());
+      writer.add(b.results().back());
+    }
+  }
+
+  auto
+  output_path() -> char const*
+  {
+    static auto const* const path = std::getenv("THREADABLE_BENCH_OUTPUT");
+    return path;
+  }
 }
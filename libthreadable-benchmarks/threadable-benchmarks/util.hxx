@@ -1,7 +1,77 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nanobench.h>
+
 namespace threadable::utils
 {
   auto do_trivial_work(int& val) -> int;
   auto do_non_trivial_work(int& val) -> int;
+
+  // 1, 2, 4, ... up to & including 'max'
+  auto thread_counts(std::size_t max = std::thread::hardware_concurrency())
+    -> std::vector<std::size_t>;
+
+  // thread counts for pools up to 'max', which have at least 2 (scheduler
+  // thread included)
+  auto pool_sizes(std::size_t max = std::thread::hardware_concurrency())
+    -> std::vector<std::size_t>;
+
+  // resident set size of the process in bytes (0 where not supported), after
+  // returning freed heap memory to the OS if possible
+  auto resident_memory() -> std::size_t;
+
+  // Set THREADABLE_BENCH_PERF to collect hardware counters of the benchmarking
+  // thread per unit: cycles, instructions, branch misses & context switches
+  // (by nanobench) and cache misses (by 'measure()'). Only that thread's, so
+  // work executed by pool threads isn't included. Timings only if counters
+  // aren't permitted (see /proc/sys/kernel/perf_event_paranoid) or supported.
+  auto perf_mode() -> bool;
+  void perf_counters(ankerl::nanobench::Bench& b);
+
+  // Set THREADABLE_BENCH_OUTPUT to a path (without extension) to also write
+  // the results of all benchmarks to '<path>.json' & '<path>.csv' on exit,
+  // which can be compared with 'compare.py'.
+  auto output_path() -> char const*;
+
+  namespace details
+  {
+    void start_cache_misses();
+    void report_cache_misses(ankerl::nanobench::Bench const& b, std::string const& name,
+                             std::uint64_t calls);
+    void collect(ankerl::nanobench::Bench const& b);
+  }
+
+  // 'b.run(name, op)', also reporting cache misses in perf mode & collecting
+  // results for output
+  template<typename op_t>
+  void
+  measure(ankerl::nanobench::Bench& b, std::string const& name, op_t&& op)
+  {
+    if (!perf_mode()) [[likely]]
+    {
+      b.run(name, op);
+    }
+    else
+    {
+      std::uint64_t calls = 0;
+      details::start_cache_misses();
+      b.run(name,
+            [&op, &calls]
+            {
+              op();
+              ++calls;
+            });
+      details::report_cache_misses(b, name, calls);
+    }
+    if (output_path()) [[unlikely]]
+    {
+      details::collect(b);
+    }
+  }
 }
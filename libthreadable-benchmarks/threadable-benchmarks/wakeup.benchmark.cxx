@@ -0,0 +1,166 @@
+#include <threadable-benchmarks/util.hxx>
+#include <threadable/histogram.hxx>
+#include <threadable/pool.hxx>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <doctest/doctest.h>
+
+#include <nanobench.h>
+
+namespace bench = ankerl::nanobench;
+namespace utils = threadable::utils;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+  using clk_t = std::chrono::steady_clock;
+
+  constexpr auto pings_per_iteration = 1 << 10;
+  constexpr auto idle_pings          = 1 << 10;
+  // long enough for a worker to be past spinning in 'queue::wait' & asleep
+  constexpr auto idle_gap = 200us;
+
+  // how the pushing thread waits for the job to signal back
+  enum class wait_strategy
+  {
+    yield,
+    atomic_wait,
+    token_wait
+  };
+
+  auto
+  to_string(wait_strategy strategy) -> std::string
+  {
+    switch (strategy)
+    {
+      case wait_strategy::yield:
+        return "yield";
+      case wait_strategy::atomic_wait:
+        return "atomic wait";
+      case wait_strategy::token_wait:
+        return "token wait";
+    }
+    return {};
+  }
+
+  struct latencies
+  {
+    threadable::histogram wake;      // push until the job starts
+    threadable::histogram roundTrip; // push until signaled back
+  };
+
+  // pushes a single job & waits for it to signal back
+  void
+  ping(auto& queue, wait_strategy strategy, latencies& latency)
+  {
+    auto       pong      = std::atomic_bool{false};
+    auto       startedAt = clk_t::time_point{};
+    auto const pushedAt  = clk_t::now();
+    auto       token     = queue.push(
+      [&pong, &startedAt]
+      {
+        startedAt = clk_t::now();
+        pong.store(true, std::memory_order_release);
+        pong.notify_one();
+      });
+    switch (strategy)
+    {
+      case wait_strategy::yield:
+        while (!pong.load(std::memory_order_acquire))
+        {
+          std::this_thread::yield();
+        }
+        break;
+      case wait_strategy::atomic_wait:
+        pong.wait(false, std::memory_order_acquire);
+        break;
+      case wait_strategy::token_wait:
+        token.wait();
+        pong.wait(false, std::memory_order_acquire);
+        break;
+    }
+    auto const now = clk_t::now();
+    latency.wake.record(startedAt - pushedAt);
+    latency.roundTrip.record(now - pushedAt);
+  }
+
+  void
+  print_latency(std::string const& name, latencies const& latency)
+  {
+    std::cout << "wake-up (" << name << "): ";
+    latency.wake.write_text(std::cout);
+    std::cout << "\nround-trip (" << name << "): ";
+    latency.roundTrip.write_text(std::cout);
+    std::cout << '\n';
+  }
+
+  constexpr wait_strategy strategies[] = {wait_strategy::yield, wait_strategy::atomic_wait,
+                                          wait_strategy::token_wait};
+
+  // The queue to ping, sticking to one worker. Another (empty) queue keeps the
+  // scheduler thread from executing it inline, so every ping is dispatched to
+  // & wakes up that worker.
+  auto
+  ping_queue(auto& pool) -> auto&
+  {
+    (void)pool.create();
+    return pool.create(threadable::execution_policy::parallel, threadable::affinity::sticky);
+  }
+}
+
+TEST_CASE("pool: wake-up latency")
+{
+  bench::Bench b;
+  b.warmup(1).relative(true).batch(pings_per_iteration).unit("ping");
+
+  for (auto workers : utils::pool_sizes())
+  {
+    auto  pool  = threadable::pool<1 << 8>(static_cast<unsigned int>(workers));
+    auto& queue = ping_queue(pool);
+
+    b.title("ping-pong (" + std::to_string(workers) + " workers)");
+    for (auto strategy : strategies)
+    {
+      auto latency = latencies{};
+      utils::measure(b, to_string(strategy),
+                     [&]
+                     {
+                       for (std::size_t i = 0; i < pings_per_iteration; ++i)
+                       {
+                         ping(queue, strategy, latency);
+                       }
+                     });
+      print_latency(to_string(strategy) + ", " + std::to_string(workers) + " workers", latency);
+    }
+  }
+}
+
+// Same as above but with the worker asleep (not spinning) at every push, so
+// only the histograms are meaningful. The scheduler thread keeps spinning.
+TEST_CASE("pool: wake-up latency (idle)")
+{
+  for (auto workers : utils::pool_sizes())
+  {
+    auto  pool  = threadable::pool<1 << 8>(static_cast<unsigned int>(workers));
+    auto& queue = ping_queue(pool);
+
+    for (auto strategy : strategies)
+    {
+      auto latency = latencies{};
+      for (std::size_t i = 0; i < idle_pings; ++i)
+      {
+        std::this_thread::sleep_for(idle_gap);
+        ping(queue, strategy, latency);
+      }
+      print_latency(to_string(strategy) + ", " + std::to_string(workers) + " idle workers",
+                    latency);
+    }
+  }
+}
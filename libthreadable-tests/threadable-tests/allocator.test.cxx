@@ -0,0 +1,82 @@
+#include <threadable-tests/doctest_include.hxx>
+#include <threadable/allocator.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+  struct alignas(64) line
+  {
+    std::uint8_t bytes[64]; // NOLINT
+  };
+
+  auto
+  is_aligned(void const* ptr, std::size_t alignment) -> bool
+  {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0; // NOLINT
+  }
+}
+
+SCENARIO("allocator: aligned allocation")
+{
+  using allocator_t = threadable::aligned_allocator<line, 64>;
+
+  for (auto kind : {threadable::pages::normal, threadable::pages::huge})
+  {
+    GIVEN(kind == threadable::pages::huge ? "huge pages" : "normal pages")
+    {
+      auto alloc = allocator_t(kind);
+      REQUIRE(alloc.page_kind() == kind);
+
+      WHEN("allocating less than a huge page")
+      {
+        auto* p = alloc.allocate(16);
+        THEN("memory is aligned & usable")
+        {
+          REQUIRE(is_aligned(p, 64));
+          p[15].bytes[63] = 1;
+          REQUIRE(p[15].bytes[63] == 1);
+        }
+        alloc.deallocate(p, 16);
+      }
+      WHEN("allocating multiple huge pages")
+      {
+        auto const n = 3 * threadable::details::huge_page_size / sizeof(line) + 1;
+        auto*      p = alloc.allocate(n);
+        THEN("memory is aligned & usable")
+        {
+          REQUIRE(is_aligned(p, 64));
+          for (std::size_t i = 0; i < n; i += 1024)
+          {
+            p[i].bytes[0] = 1;
+          }
+          p[n - 1].bytes[63] = 1;
+          REQUIRE(p[n - 1].bytes[63] == 1);
+        }
+        alloc.deallocate(p, n);
+      }
+      WHEN("used by a container")
+      {
+        auto v = std::vector<line, allocator_t>(1 << 16, alloc);
+        THEN("it keeps the page kind")
+        {
+          REQUIRE(v.get_allocator() == alloc);
+          REQUIRE(is_aligned(v.data(), 64));
+        }
+      }
+    }
+  }
+  GIVEN("allocators of different page kinds")
+  {
+    auto const normal = allocator_t(threadable::pages::normal);
+    auto const huge   = allocator_t(threadable::pages::huge);
+    THEN("they are not interchangeable")
+    {
+      REQUIRE(normal == allocator_t{});
+      REQUIRE_FALSE(normal == huge);
+      REQUIRE(threadable::aligned_allocator<int, 64>(huge).page_kind() == threadable::pages::huge);
+    }
+  }
+}
@@ -486,6 +486,28 @@ SCENARIO("function: set/reset")
         REQUIRE(argReceived == 5);
       }
     }
+    WHEN("callable of known type is set")
+    {
+      struct type
+      {
+        int val = 0;
+
+        void
+        operator()()
+        {}
+      };
+
+      func.set(type{.val = 3});
+      THEN("it can be accessed as that type")
+      {
+        REQUIRE(func.target<type>());
+        REQUIRE(func.target<type>()->val == 3);
+      }
+      THEN("it can't be accessed as another type")
+      {
+        REQUIRE_FALSE(func.target<void (*)()>());
+      }
+    }
     WHEN("recursive callable is set")
     {
       int  val      = 0;
@@ -0,0 +1,110 @@
+#include <threadable-tests/doctest_include.hxx>
+#include <threadable/histogram.hxx>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+
+using namespace std::chrono_literals;
+
+SCENARIO("histogram: buckets")
+{
+  using threadable::histogram;
+  GIVEN("small values")
+  {
+    THEN("each has its own bucket")
+    {
+      for (std::uint64_t v = 0; v < 2 * histogram::sub_buckets; ++v)
+      {
+        REQUIRE(histogram::bucket(v) == v);
+        REQUIRE(histogram::upper_bound(histogram::bucket(v)) == v);
+      }
+    }
+  }
+  GIVEN("large values")
+  {
+    THEN("they end up in a bucket with a relative error of at most 1/8")
+    {
+      for (std::uint64_t v : {std::uint64_t{17}, std::uint64_t{1000}, std::uint64_t{123456789},
+                              std::uint64_t{1} << 40, ~std::uint64_t{0}})
+      {
+        auto const bucket = histogram::bucket(v);
+        REQUIRE(bucket < histogram::buckets);
+        REQUIRE(histogram::upper_bound(bucket) >= v);
+        REQUIRE(histogram::upper_bound(bucket) - v <= v / histogram::sub_buckets);
+        REQUIRE(histogram::upper_bound(bucket - 1) < v);
+      }
+    }
+  }
+}
+
+SCENARIO("histogram: record")
+{
+  auto h = threadable::histogram{};
+  GIVEN("nothing recorded")
+  {
+    THEN("everything is zero")
+    {
+      REQUIRE(h.count() == 0);
+      REQUIRE(h.mean() == 0ns);
+      REQUIRE(h.percentile(0.99) == 0ns);
+    }
+  }
+  GIVEN("1..100 ns recorded")
+  {
+    for (std::size_t i = 1; i <= 100; ++i)
+    {
+      h.record(std::chrono::nanoseconds(i));
+    }
+    THEN("stats are within bucket precision")
+    {
+      REQUIRE(h.count() == 100);
+      REQUIRE(h.mean() == 50ns);
+      REQUIRE(h.max() == 100ns);
+      REQUIRE(h.percentile(0.5) >= 50ns);
+      REQUIRE(h.percentile(0.5) <= 55ns);
+      REQUIRE(h.percentile(0.99) >= 99ns);
+      REQUIRE(h.percentile(1.0) == 100ns);
+    }
+    AND_WHEN("merged with another histogram")
+    {
+      auto other = threadable::histogram{};
+      other.record(1ms);
+      h.merge(other);
+      THEN("it includes both")
+      {
+        REQUIRE(h.count() == 101);
+        REQUIRE(h.max() == 1ms);
+        REQUIRE(h.percentile(0.5) <= 55ns);
+      }
+    }
+    AND_WHEN("written as json")
+    {
+      auto os = std::ostringstream{};
+      h.write_json(os);
+      THEN("summary & buckets are included")
+      {
+        auto const json = os.str();
+        REQUIRE(json.front() == '{');
+        REQUIRE(json.back() == '}');
+        REQUIRE(json.find(R"("count":100)") != std::string::npos);
+        REQUIRE(json.find(R"("max_ns":100)") != std::string::npos);
+        REQUIRE(json.find(R"("buckets":[[1,1],[2,1])") != std::string::npos);
+      }
+    }
+  }
+  GIVEN("recorded atomically")
+  {
+    auto atomic = threadable::details::atomic_histogram{};
+    atomic.record(10ns);
+    atomic.record(20ns);
+    THEN("a snapshot holds all values")
+    {
+      auto const snapshot = atomic.snapshot();
+      REQUIRE(snapshot.count() == 2);
+      REQUIRE(snapshot.mean() == 15ns);
+      REQUIRE(snapshot.max() == 20ns);
+    }
+  }
+}
@@ -1,13 +1,32 @@
 #include <threadable-tests/doctest_include.hxx>
 #include <threadable/pool.hxx>
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <thread>
 #include <vector>
 
 using namespace std::chrono_literals;
 
+namespace
+{
+  // polls 'pred' until true or timed out, returns its last result
+  auto
+  wait_until(auto&& pred) -> bool
+  {
+    auto const deadline = std::chrono::steady_clock::now() + 10s;
+    while (!pred() && std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(1ms);
+    }
+    return pred();
+  }
+}
+
 SCENARIO("pool: create/remove queues")
 {
   auto pool = threadable::pool();
@@ -32,6 +51,38 @@ SCENARIO("pool: create/remove queues")
     {
       REQUIRE(pool.remove(std::move(queue)));
     }
+    WHEN("queue is removed while a job of it executes")
+    {
+      auto started  = std::atomic_bool{false};
+      auto released = std::atomic_bool{false};
+      auto finished = std::atomic_bool{false};
+      (void)queue.push(
+        [&]
+        {
+          started = true;
+          started.notify_one();
+          released.wait(false);
+          finished = true;
+          finished.notify_one();
+        });
+      started.wait(false);
+      REQUIRE(pool.remove(std::move(queue)));
+      REQUIRE(pool.queues() == 0);
+      THEN("the job finishes & the pool keeps executing jobs")
+      {
+        released = true;
+        released.notify_one();
+        finished.wait(false);
+
+        auto token = pool.create().push(
+          [&called]
+          {
+            ++called;
+          });
+        token.wait();
+        REQUIRE(called == 1);
+      }
+    }
     // @TODO: Figure out how to test this (token.wait() on potentially removed job)
     // WHEN("queue is removed inside a job")
     // {
@@ -137,6 +188,463 @@ SCENARIO("pool: push jobs to global pool")
   }
 }
 
+SCENARIO("pool: help while waiting")
+{
+  auto pool = threadable::pool(2);
+  GIVEN("jobs recursively pushing children & waiting for them")
+  {
+    using queue_t = decltype(pool)::queue_t;
+
+    struct fork
+    {
+      queue_t*            queue;
+      std::atomic_size_t* counter;
+      std::size_t         depth;
+
+      void
+      operator()() const
+      {
+        ++(*counter);
+        if (depth > 0)
+        {
+          threadable::token_group group;
+          group += queue->push(fork{queue, counter, depth - 1});
+          group += queue->push(fork{queue, counter, depth - 1});
+          group.wait();
+        }
+      }
+    };
+
+    constexpr std::size_t depth   = 6;
+    auto&                 queue   = pool.create();
+    auto                  counter = std::atomic_size_t{0};
+
+    auto token = queue.push(fork{&queue, &counter, depth});
+    token.wait();
+    THEN("waiting pool threads execute pending jobs instead of deadlocking")
+    {
+      REQUIRE(counter.load() == (std::size_t{1} << (depth + 1)) - 1);
+    }
+  }
+  GIVEN("a job in a sequential queue waiting for a job in another queue")
+  {
+    auto& sequential = pool.create(threadable::execution_policy::sequential);
+    auto& parallel   = pool.create(threadable::execution_policy::parallel);
+    auto  started    = std::atomic_bool{false};
+    auto  released   = std::atomic_bool{false};
+
+    auto first = sequential.push(
+      [&]
+      {
+        auto child = parallel.push(
+          [&]
+          {
+            started = true;
+            started.notify_one();
+            released.wait(false);
+          });
+        child.wait();
+      });
+    started.wait(false);
+    WHEN("the next job of the sequential queue is pushed meanwhile")
+    {
+      auto second = sequential.push([] {});
+      std::this_thread::sleep_for(10ms); // let the waiting thread look for work
+      released = true;
+      released.notify_one();
+      THEN("the waiting thread doesn't execute it (waiting on itself)")
+      {
+        first.wait();
+        second.wait();
+        REQUIRE(first.done());
+        REQUIRE(second.done());
+      }
+    }
+  }
+}
+
+SCENARIO("pool: split ranges")
+{
+  constexpr std::size_t nr_of_jobs = 16;
+
+  auto pool    = threadable::pool(4);
+  auto mutex   = std::mutex{};
+  auto threads = std::set<std::thread::id>{};
+  auto job     = [&]
+  {
+    std::this_thread::sleep_for(1ms);
+    auto _ = std::scoped_lock{mutex};
+    threads.insert(std::this_thread::get_id());
+  };
+
+  // pushes a burst of (known to be) expensive jobs that is consumed at once
+  auto const burst = [&](auto& queue)
+  {
+    auto warmup = threadable::token_group{};
+    for (std::size_t i = 0; i < nr_of_jobs; ++i)
+    {
+      warmup += queue.push(job);
+    }
+    warmup.wait();
+    std::this_thread::sleep_for(10ms); // let workers go idle
+    threads.clear();
+
+    auto started  = std::atomic_bool{false};
+    auto released = std::atomic_bool{false};
+    auto group    = threadable::token_group{};
+    group += queue.push(
+      [&]
+      {
+        started = true;
+        started.notify_one();
+        released.wait(false);
+      });
+    started.wait(false);
+    for (std::size_t i = 0; i < nr_of_jobs; ++i)
+    {
+      group += queue.push(job);
+    }
+    released = true;
+    released.notify_one();
+    group.wait();
+  };
+
+  GIVEN("a burst of jobs in a parallel queue")
+  {
+    burst(pool.create(threadable::execution_policy::parallel));
+    THEN("they're spread over idle workers")
+    {
+      REQUIRE(threads.size() > 1);
+    }
+  }
+  GIVEN("a burst of jobs in a sequential queue")
+  {
+    burst(pool.create(threadable::execution_policy::sequential));
+    THEN("they execute on a single thread")
+    {
+      REQUIRE(threads.size() == 1);
+    }
+  }
+}
+
+SCENARIO("pool: sticky affinity")
+{
+  auto  pool  = threadable::pool(4);
+  auto& other = pool.create(); // (a single queue is executed by the scheduler thread)
+  (void)other;
+  GIVEN("a queue with sticky affinity")
+  {
+    auto& queue =
+      pool.create(threadable::execution_policy::parallel, threadable::affinity::sticky);
+    auto threads = std::set<std::thread::id>{};
+    WHEN("jobs are pushed one at a time")
+    {
+      for (std::size_t i = 0; i < 32; ++i)
+      {
+        auto token = queue.push(
+          [&threads]
+          {
+            threads.insert(std::this_thread::get_id());
+          });
+        token.wait();
+      }
+      THEN("they're all executed by the same worker")
+      {
+        REQUIRE(threads.size() == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("pool: spawn jobs")
+{
+  auto pool    = threadable::pool(2);
+  auto counter = std::atomic_size_t{0};
+  GIVEN("job is spawned outside of pool")
+  {
+    auto token = pool.spawn(
+      [&counter]
+      {
+        ++counter;
+      });
+    THEN("it gets executed")
+    {
+      token.wait();
+      REQUIRE(counter.load() == 1);
+    }
+  }
+  GIVEN("jobs recursively spawning children & waiting for them")
+  {
+    using pool_t = decltype(pool);
+
+    struct fork
+    {
+      pool_t*             pool;
+      std::atomic_size_t* counter;
+      std::size_t         depth;
+
+      void
+      operator()() const
+      {
+        ++(*counter);
+        if (depth > 0)
+        {
+          threadable::token_group group;
+          group += pool->spawn(fork{pool, counter, depth - 1});
+          group += pool->spawn(fork{pool, counter, depth - 1});
+          group.wait();
+        }
+      }
+    };
+
+    constexpr std::size_t depth = 10;
+    auto&                 queue = pool.create();
+
+    auto token = queue.push(fork{&pool, &counter, depth});
+    token.wait();
+    THEN("all get executed")
+    {
+      REQUIRE(counter.load() == (std::size_t{1} << (depth + 1)) - 1);
+    }
+  }
+  GIVEN("job spawns children without waiting for them")
+  {
+    constexpr std::size_t   nr_of_jobs = threadable::details::local_queue_size * 2;
+    threadable::token_group group;
+    auto&                   queue = pool.create();
+
+    auto token = queue.push(
+      [&pool, &counter, &group]
+      {
+        for (std::size_t i = 0; i < nr_of_jobs; ++i)
+        {
+          group += pool.spawn(
+            [&counter]
+            {
+              ++counter;
+            });
+        }
+      });
+    token.wait();
+    group.wait();
+    THEN("all get executed")
+    {
+      REQUIRE(counter.load() == nr_of_jobs);
+    }
+  }
+  GIVEN("pool is destroyed while jobs keep spawning children")
+  {
+    auto spawned = std::atomic_size_t{0};
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+      auto other = std::make_unique<threadable::pool<1 << 8>>(4);
+      for (auto* queue : {&other->create(), &other->create()})
+      {
+        for (std::size_t j = 0; j < 8; ++j)
+        {
+          (void)queue->push(
+            [&pool = *other, &spawned, &counter]
+            {
+              for (std::size_t k = 0; k < 64; ++k)
+              {
+                ++spawned;
+                (void)pool.spawn(
+                  [&counter]
+                  {
+                    ++counter;
+                  });
+              }
+            });
+        }
+      }
+      other.reset();
+    }
+    THEN("all spawned jobs get executed")
+    {
+      REQUIRE(counter.load() == spawned.load());
+    }
+  }
+}
+
+SCENARIO("pool: elastic workers")
+{
+  auto pool = threadable::pool(threadable::elasticity{
+    .min_workers  = 2,
+    .max_workers  = 4,
+    .grow_backlog = 0,
+    .idle_timeout = 50ms,
+    .cooldown     = 1ms,
+  });
+  REQUIRE(pool.workers() == 2);
+
+  GIVEN("jobs keep piling up in multiple queues")
+  {
+    auto  group   = threadable::token_group{};
+    auto  release = std::atomic_bool{false};
+    auto& queue1  = pool.create();
+    auto& queue2  = pool.create();
+    for (std::size_t i = 0; i < 64; ++i)
+    {
+      for (auto* queue : {&queue1, &queue2})
+      {
+        group += queue->push(
+          [&release]
+          {
+            while (!release.load())
+            {
+              std::this_thread::sleep_for(1ms);
+            }
+          });
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+    THEN("workers are spawned up to max")
+    {
+      auto const grown = wait_until(
+        [&pool]
+        {
+          return pool.workers() == 4;
+        });
+      release = true;
+      group.wait();
+      REQUIRE(grown);
+      AND_WHEN("workers are idle for longer than the timeout")
+      {
+        THEN("they are retired down to min")
+        {
+          REQUIRE(wait_until(
+            [&pool]
+            {
+              return pool.workers() == 2;
+            }));
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("pool: blocking region")
+{
+  auto pool = threadable::pool(threadable::elasticity{
+    .min_workers  = 2,
+    .max_workers  = 2,
+    .idle_timeout = 50ms,
+    .cooldown     = 1ms,
+  });
+  REQUIRE(pool.workers() == 2);
+
+  GIVEN("a job blocks inside a region until released by a job pushed later")
+  {
+    auto  started = std::atomic_bool{false};
+    auto  release = std::atomic_bool{false};
+    auto& queue   = pool.create();
+
+    auto blocked = queue.push(
+      [&started, &release]
+      {
+        auto _ = threadable::blocking_region{};
+        started = true;
+        while (!release.load())
+        {
+          std::this_thread::sleep_for(1ms);
+        }
+      });
+    REQUIRE(wait_until(
+      [&started]
+      {
+        return started.load();
+      }));
+    auto const compensated = pool.workers();
+
+    auto releaser = queue.push(
+      [&release]
+      {
+        release = true;
+      });
+    releaser.wait();
+    blocked.wait();
+
+    THEN("a compensation worker is started meanwhile")
+    {
+      REQUIRE(compensated == 3);
+      AND_WHEN("it's idle for longer than the timeout")
+      {
+        THEN("it's retired")
+        {
+          REQUIRE(wait_until(
+            [&pool]
+            {
+              return pool.workers() == 2;
+            }));
+        }
+      }
+    }
+  }
+  GIVEN("a region outside of the pool")
+  {
+    {
+      auto _ = threadable::blocking_region{};
+    }
+    THEN("nothing happens")
+    {
+      REQUIRE(pool.workers() == 2);
+    }
+  }
+}
+
+SCENARIO("pool: statistics")
+{
+  auto  pool  = threadable::pool(4);
+  auto& queue = pool.create();
+  GIVEN("jobs are pushed & executed")
+  {
+    auto group = threadable::token_group{};
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+      group += queue.push([] {});
+    }
+    group.wait();
+    THEN("a snapshot has an entry per queue & running worker")
+    {
+      auto const stats = pool.stats();
+      REQUIRE(stats.queues.size() == 1);
+      REQUIRE(stats.workers.size() == pool.workers() - 1);
+      if constexpr (threadable::details::stats_enabled)
+      {
+        REQUIRE(stats.queues[0].pushed == 100);
+        REQUIRE(stats.scheduler_iterations > 0);
+      }
+      else
+      {
+        REQUIRE(stats.queues[0].pushed == 0);
+        REQUIRE(stats.scheduler_iterations == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("pool: memory usage")
+{
+  auto       pool   = threadable::pool<8>(2);
+  auto const before = pool.memory_usage();
+  GIVEN("a queue is created")
+  {
+    auto& queue = pool.create();
+    THEN("it's included")
+    {
+      REQUIRE(pool.memory_usage() >= before + queue.memory_usage());
+    }
+    AND_WHEN("it's removed")
+    {
+      REQUIRE(pool.remove(std::move(queue)));
+      THEN("it's no longer included")
+      {
+        REQUIRE(pool.memory_usage() < before + sizeof(threadable::job) * 8);
+      }
+    }
+  }
+}
+
 SCENARIO("pool: stress-test")
 {
   constexpr auto capacity = std::size_t{1 << 18};
@@ -3,11 +3,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace
 {
@@ -18,6 +20,30 @@ namespace
     auto addr = reinterpret_cast<std::uintptr_t>(ptr); // NOLINT
     return (addr % alignment) == 0;
   }
+
+  // blocks when copied (i.e. while being pushed) until released
+  struct stalling_job
+  {
+    stalling_job(std::atomic_bool& copying, std::atomic_bool& release)
+      : copying(&copying)
+      , release(&release)
+    {}
+
+    stalling_job(stalling_job const& rhs)
+      : copying(rhs.copying)
+      , release(rhs.release)
+    {
+      copying->store(true, std::memory_order_release);
+      release->wait(false, std::memory_order_acquire);
+    }
+
+    void
+    operator()() const
+    {}
+
+    std::atomic_bool* copying;
+    std::atomic_bool* release;
+  };
 }
 
 SCENARIO("queue: push & claim")
@@ -228,6 +254,17 @@ SCENARIO("queue: push & claim")
           }
         }
       }
+      AND_WHEN("consume and execute a limited amount of jobs")
+      {
+        REQUIRE(queue.execute(queue.max_size() - 1) == queue.max_size() - 1);
+        THEN("the rest is left in the queue")
+        {
+          REQUIRE(queue.size() == 1);
+          REQUIRE(queue.execute() == 1);
+          REQUIRE(jobsExecuted.size() == queue.max_size());
+          REQUIRE(jobsExecuted.back() == queue.max_size() - 1);
+        }
+      }
     }
   }
 }
@@ -284,6 +321,97 @@ SCENARIO("queue: execution order")
   }
 }
 
+SCENARIO("queue: single producer")
+{
+  GIVEN("a sequential queue with a single producer")
+  {
+    auto queue = threadable::queue<1 << 10, threadable::producer::single>(
+      threadable::execution_policy::sequential);
+
+    WHEN("one thread pushes while another consumes & executes")
+    {
+      auto order    = std::vector<std::size_t>{};
+      auto producer = std::thread(
+        [&queue, &order]
+        {
+          for (std::size_t i = 0; i < queue.max_size(); ++i)
+          {
+            queue.push(
+              [&order, i]
+              {
+                order.push_back(i);
+              });
+          }
+        });
+      for (std::size_t executed = 0; executed < queue.max_size();)
+      {
+        executed += queue.execute();
+      }
+      producer.join();
+
+      THEN("all jobs are executed FIFO")
+      {
+        REQUIRE(order.size() == queue.max_size());
+        for (std::size_t i = 0; i < queue.max_size(); ++i)
+        {
+          REQUIRE(order[i] == i);
+        }
+        REQUIRE(queue.empty());
+      }
+    }
+  }
+}
+
+SCENARIO("queue: commit order")
+{
+  GIVEN("a push stalled before committing its slot")
+  {
+    auto queue   = threadable::queue<8>{};
+    auto copying = std::atomic_bool{false};
+    auto release = std::atomic_bool{false};
+    auto first   = std::thread(
+      [&queue, &copying, &release]
+      {
+        auto const job = stalling_job(copying, release);
+        queue.push(job);
+      });
+    while (!copying.load(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+
+    WHEN("another producer pushes meanwhile")
+    {
+      auto pushed = std::atomic_bool{false};
+      auto second = std::thread(
+        [&queue, &pushed]
+        {
+          queue.push([] {});
+          pushed.store(true, std::memory_order_release);
+        });
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      auto const pushedBefore = pushed.load(std::memory_order_acquire);
+      auto const sizeBefore   = queue.size();
+
+      release.store(true, std::memory_order_release);
+      release.notify_all();
+      first.join();
+      second.join();
+
+      THEN("it waits for (yielding to) the earlier push before committing its own")
+      {
+        REQUIRE_FALSE(pushedBefore);
+        REQUIRE(sizeBefore == 0);
+        REQUIRE(queue.size() == 2);
+        if constexpr (threadable::details::stats_enabled)
+        {
+          REQUIRE(queue.stats().commit_yields == 1);
+        }
+      }
+    }
+  }
+}
+
 SCENARIO("queue: completion token")
 {
   auto queue = threadable::queue{};
@@ -344,6 +472,145 @@ SCENARIO("queue: completion token")
   }
 }
 
+SCENARIO("queue: statistics")
+{
+  auto queue = threadable::queue<8>{};
+  GIVEN("3 jobs are pushed & executed in two batches")
+  {
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      queue.push([] {});
+    }
+    REQUIRE(queue.execute(2) == 2);
+    REQUIRE(queue.execute() == 1);
+    THEN("counters are updated if enabled")
+    {
+      auto const stats = queue.stats();
+      if constexpr (threadable::details::stats_enabled)
+      {
+        REQUIRE(stats.pushed == 3);
+        REQUIRE(stats.executed == 3);
+        REQUIRE(stats.high_water == 3);
+        REQUIRE(stats.full_stalls == 0);
+      }
+      else
+      {
+        REQUIRE(stats.pushed == 0);
+        REQUIRE(stats.executed == 0);
+        REQUIRE(stats.high_water == 0);
+      }
+    }
+    THEN("latencies are recorded if enabled")
+    {
+      auto const latency = queue.latency();
+      if constexpr (threadable::details::latency_enabled)
+      {
+        REQUIRE(latency.queued.count() == 3);
+        REQUIRE(latency.run.count() == 3);
+      }
+      else
+      {
+        REQUIRE(latency.queued.count() == 0);
+        REQUIRE(latency.run.count() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("queue: inline execution")
+{
+  auto queue = threadable::queue<8>{threadable::execution_policy::parallel};
+  REQUIRE(queue.cost() == std::chrono::nanoseconds{0});
+  GIVEN("a single (expensive) job is executed")
+  {
+    auto thread = std::thread::id{};
+    queue.push(
+      [&thread]
+      {
+        thread = std::this_thread::get_id();
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      });
+    REQUIRE(queue.execute() == 1);
+    THEN("it's executed on the calling thread & its cost is estimated")
+    {
+      REQUIRE(thread == std::this_thread::get_id());
+      REQUIRE(queue.cost() >= std::chrono::milliseconds{1});
+      if constexpr (threadable::details::stats_enabled)
+      {
+        REQUIRE(queue.stats().inlined == 1);
+      }
+    }
+    AND_WHEN("more jobs like it are executed")
+    {
+      for (std::size_t i = 0; i < 2; ++i)
+      {
+        queue.push(
+          []
+          {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+          });
+      }
+      REQUIRE(queue.execute() == 2);
+      THEN("they're executed in parallel")
+      {
+        REQUIRE(queue.cost() >= std::chrono::microseconds{100});
+        if constexpr (threadable::details::stats_enabled)
+        {
+          REQUIRE(queue.stats().inlined == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("queue: memory usage")
+{
+  GIVEN("queues of different capacity")
+  {
+    auto const small = threadable::queue<8>{};
+    auto const large = threadable::queue<16>{};
+    THEN("the difference is the extra job slots")
+    {
+      auto const perJob = sizeof(threadable::job) +
+                          (threadable::details::latency_enabled ? sizeof(std::int64_t) : 0);
+      REQUIRE(small.memory_usage() >= sizeof(small) + 8 * sizeof(threadable::job));
+      REQUIRE(large.memory_usage() - small.memory_usage() == 8 * perJob);
+    }
+  }
+}
+
+SCENARIO("queue: huge pages")
+{
+  GIVEN("a queue backed by huge pages")
+  {
+    static constexpr auto queue_capacity = 1 << 16; // 4 MiB of job slots
+    auto queue = threadable::queue<queue_capacity>(threadable::execution_policy::parallel,
+                                                   threadable::pages::huge);
+    THEN("job slots are whole huge pages")
+    {
+      REQUIRE(queue.memory_usage() >= 2 * threadable::details::huge_page_size);
+      REQUIRE(is_aligned(&*queue.begin(), threadable::details::cache_line_size));
+    }
+    WHEN("push & execute all")
+    {
+      auto called = std::atomic_size_t{0};
+      for (std::size_t i = 0; i < queue.max_size(); ++i)
+      {
+        queue.push(
+          [&called]
+          {
+            ++called;
+          });
+      }
+      REQUIRE(queue.execute() == queue.max_size());
+      THEN("all are executed")
+      {
+        REQUIRE(called == queue.max_size());
+      }
+    }
+  }
+}
+
 SCENARIO("queue: stress-test")
 {
   GIVEN("produce & consume enough for wrap-around")
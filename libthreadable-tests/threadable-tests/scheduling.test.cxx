@@ -0,0 +1,130 @@
+#include <threadable-tests/doctest_include.hxx>
+#include <threadable/pool.hxx>
+#include <threadable/scheduling.hxx>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <set>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+  template<threadable::scheduling::policy policy_t>
+  auto
+  execute_jobs(std::size_t nrOfJobs) -> std::size_t
+  {
+    auto  pool    = threadable::pool<1 << 8, policy_t>(4);
+    auto& queue1  = pool.create();
+    auto& queue2  = pool.create(threadable::execution_policy::sequential);
+    auto  counter = std::atomic_size_t{0};
+    auto  group   = threadable::token_group{};
+    for (std::size_t i = 0; i < nrOfJobs; ++i)
+    {
+      group += (i % 2 == 0 ? queue1 : queue2)
+                 .push(
+                   [&counter]
+                   {
+                     ++counter;
+                   });
+    }
+    group.wait();
+    return counter.load();
+  }
+}
+
+SCENARIO("scheduling: built-in policies")
+{
+  using threadable::scheduling::load;
+
+  auto const loads  = std::array{load{3, 300}, load{1, 100}, load{2, 100}, load::max()};
+  auto const loadOf = [&loads](std::size_t i)
+  {
+    return loads[i];
+  };
+
+  GIVEN("round-robin")
+  {
+    auto policy = threadable::scheduling::round_robin{};
+    THEN("candidates & first queues are taken in turn")
+    {
+      REQUIRE(policy.pick(3, loadOf) == 0);
+      REQUIRE(policy.pick(3, loadOf) == 1);
+      REQUIRE(policy.pick(3, loadOf) == 2);
+      REQUIRE(policy.pick(3, loadOf) == 0);
+      REQUIRE(policy.begin_pass(2, 3) == 0);
+      REQUIRE(policy.begin_pass(2, 3) == 1);
+      REQUIRE(policy.begin_pass(2, 3) == 0);
+    }
+  }
+  GIVEN("least loaded")
+  {
+    auto policy = threadable::scheduling::least_loaded{};
+    THEN("the candidate with the least work is picked (fewest ranges on a tie)")
+    {
+      REQUIRE(policy.pick(loads.size(), loadOf) == 1);
+      REQUIRE(policy.pick(1, loadOf) == 0);
+    }
+  }
+  GIVEN("random")
+  {
+    auto policy = threadable::scheduling::random{};
+    THEN("a (new) candidate is picked per range")
+    {
+      auto picked = std::set<std::size_t>{};
+      for (int i = 0; i < 64; ++i)
+      {
+        picked.insert(policy.pick(3, loadOf));
+      }
+      REQUIRE(picked.size() > 1);
+      REQUIRE(*picked.rbegin() < 3);
+    }
+  }
+  GIVEN("power of two choices")
+  {
+    auto policy = threadable::scheduling::power_of_two{};
+    THEN("the less busy of two candidates is picked")
+    {
+      auto picked = std::set<std::size_t>{};
+      for (int i = 0; i < 64; ++i)
+      {
+        picked.insert(policy.pick(2, loadOf));
+        REQUIRE(policy.pick(1, loadOf) == 0);
+      }
+      REQUIRE(picked == std::set<std::size_t>{1});
+    }
+    THEN("the busiest candidate is never picked")
+    {
+      for (int i = 0; i < 64; ++i)
+      {
+        REQUIRE(policy.pick(loads.size(), loadOf) != 3);
+      }
+    }
+  }
+  GIVEN("any policy")
+  {
+    THEN("chunks are worth splitting off")
+    {
+      REQUIRE(threadable::scheduling::default_chunk(0ns) ==
+              static_cast<std::size_t>(threadable::scheduling::min_chunk / 1ns));
+      REQUIRE(threadable::scheduling::default_chunk(1ms) == 1);
+    }
+  }
+}
+
+SCENARIO("scheduling: pools with different policies")
+{
+  constexpr std::size_t nr_of_jobs = 256; // 128 per queue
+  GIVEN("jobs pushed to multiple queues")
+  {
+    THEN("all are executed with every policy")
+    {
+      REQUIRE(execute_jobs<threadable::scheduling::random>(nr_of_jobs) == nr_of_jobs);
+      REQUIRE(execute_jobs<threadable::scheduling::power_of_two>(nr_of_jobs) == nr_of_jobs);
+      REQUIRE(execute_jobs<threadable::scheduling::round_robin>(nr_of_jobs) == nr_of_jobs);
+      REQUIRE(execute_jobs<threadable::scheduling::least_loaded>(nr_of_jobs) == nr_of_jobs);
+    }
+  }
+}
@@ -0,0 +1,159 @@
+#include <threadable-tests/doctest_include.hxx>
+#include <threadable/soa_queue.hxx>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+SCENARIO("soa_queue: push & execute")
+{
+  GIVEN("queue with capacity 128")
+  {
+    auto queue = threadable::soa_queue<128>{};
+    REQUIRE(queue.empty());
+    REQUIRE(queue.pending() == 0);
+
+    auto order = std::vector<std::size_t>{};
+    WHEN("push all")
+    {
+      auto tokens = threadable::token_group{};
+      for (std::size_t i = 0; i < queue.max_size(); ++i)
+      {
+        tokens += queue.push(
+          [i, &order]
+          {
+            order.push_back(i);
+          });
+      }
+      REQUIRE(queue.size() == queue.max_size());
+      REQUIRE(queue.pending() == queue.max_size());
+      REQUIRE_FALSE(tokens.done());
+
+      AND_WHEN("execute a limited amount of jobs")
+      {
+        REQUIRE(queue.execute(10) == 10);
+        THEN("the rest is left in the queue")
+        {
+          REQUIRE(queue.size() == queue.max_size() - 10);
+          REQUIRE(queue.pending() == queue.max_size() - 10);
+          REQUIRE(order.size() == 10);
+        }
+      }
+      AND_WHEN("execute all jobs")
+      {
+        REQUIRE(queue.execute() == queue.max_size());
+        THEN("they are executed FIFO & done")
+        {
+          REQUIRE(order.size() == queue.max_size());
+          for (std::size_t i = 0; i < queue.max_size(); ++i)
+          {
+            REQUIRE(order[i] == i);
+          }
+          REQUIRE(tokens.done());
+          REQUIRE(queue.empty());
+          REQUIRE(queue.pending() == 0);
+        }
+      }
+      AND_WHEN("clear")
+      {
+        queue.clear();
+        THEN("no job was executed, but all are done")
+        {
+          REQUIRE(order.empty());
+          REQUIRE(tokens.done());
+          REQUIRE(queue.empty());
+          REQUIRE(queue.pending() == 0);
+        }
+      }
+    }
+  }
+  GIVEN("queue with capacity 16")
+  {
+    auto queue = threadable::soa_queue<16>{};
+    WHEN("jobs are pushed & executed over many laps (in uneven batches)")
+    {
+      std::size_t pushed   = 0;
+      std::size_t executed = 0;
+      std::size_t called   = 0;
+      for (std::size_t lap = 0; lap < 64; ++lap)
+      {
+        for (std::size_t i = 0; i < lap % queue.max_size() + 1; ++i, ++pushed)
+        {
+          queue.push(
+            [&called]
+            {
+              ++called;
+            });
+        }
+        executed += queue.execute(lap % 3 + 1);
+        executed += queue.execute();
+      }
+      THEN("all are executed once")
+      {
+        REQUIRE(executed == pushed);
+        REQUIRE(called == pushed);
+        REQUIRE(queue.empty());
+        REQUIRE(queue.pending() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("soa_queue: concurrent producers")
+{
+  static constexpr auto producers = std::size_t{4};
+
+  auto queue  = threadable::soa_queue<1 << 12>{};
+  auto called = std::atomic_size_t{0};
+  GIVEN("multiple threads pushing (in total as many jobs as fit)")
+  {
+    auto const perProducer = queue.max_size() / producers;
+    auto       threads     = std::vector<std::thread>{};
+    for (std::size_t p = 0; p < producers; ++p)
+    {
+      threads.emplace_back(
+        [&]
+        {
+          for (std::size_t i = 0; i < perProducer; ++i)
+          {
+            queue.push(
+              [&called]
+              {
+                ++called;
+              });
+          }
+        });
+    }
+    WHEN("one thread waits for & executes them")
+    {
+      for (std::size_t executed = 0; executed < perProducer * producers;)
+      {
+        queue.wait();
+        executed += queue.execute();
+      }
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+      THEN("all are executed once")
+      {
+        REQUIRE(called == perProducer * producers);
+        REQUIRE(queue.pending() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("soa_queue: memory usage")
+{
+  GIVEN("a queue")
+  {
+    auto queue = threadable::soa_queue<1 << 10>{};
+    THEN("it's a byte of state & a cache line of body per job")
+    {
+      REQUIRE(queue.memory_usage() >=
+              (1 << 10) * (1 + threadable::details::cache_line_size));
+    }
+  }
+}
@@ -0,0 +1,110 @@
+#include <threadable-tests/doctest_include.hxx>
+#include <threadable/trace.hxx>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+SCENARIO("trace: buffer")
+{
+  using threadable::details::trace_buffer;
+  using threadable::details::trace_buffer_size;
+
+  auto buffer = std::make_unique<trace_buffer>(1);
+  GIVEN("a few events are recorded")
+  {
+    for (std::int64_t i = 0; i < 3; ++i)
+    {
+      buffer->record({"event", 7, i, i + 1});
+    }
+    THEN("all are read back in order")
+    {
+      auto const events = buffer->events();
+      REQUIRE(events.size() == 3);
+      REQUIRE(std::string(events[0].name) == "event");
+      REQUIRE(events[0].id == 7);
+      REQUIRE(events[2].begin == 2);
+      REQUIRE(events[2].end == 3);
+    }
+  }
+  GIVEN("more events than fit are recorded")
+  {
+    for (std::int64_t i = 0; i < static_cast<std::int64_t>(trace_buffer_size) + 5; ++i)
+    {
+      buffer->record({"event", 0, i, i});
+    }
+    THEN("the most recent are kept")
+    {
+      auto const events = buffer->events();
+      REQUIRE(events.size() == trace_buffer_size);
+      REQUIRE(events.front().begin == 5);
+      REQUIRE(events.back().begin == static_cast<std::int64_t>(trace_buffer_size) + 4);
+    }
+  }
+}
+
+SCENARIO("trace: threads coming & going")
+{
+  auto&      registry = threadable::details::trace_buffers();
+  auto const traced   = []
+  {
+    std::thread(
+      []
+      {
+        auto _ = threadable::details::trace_scope<true>("exited", 1);
+      })
+      .join();
+  };
+  auto const buffers  = [&registry]
+  {
+    auto _ = std::scoped_lock{registry.mutex};
+    return registry.buffers.size();
+  };
+
+  GIVEN("a thread traces & exits")
+  {
+    traced();
+    auto const before = buffers();
+    WHEN("more threads trace & exit")
+    {
+      traced();
+      traced();
+      THEN("its buffer is reused")
+      {
+        REQUIRE(buffers() == before);
+      }
+      THEN("their events are kept until written")
+      {
+        auto _ = std::scoped_lock{registry.mutex};
+        REQUIRE(registry.retired.size() >= 3);
+        REQUIRE(std::string(registry.retired.back().events.front().name) == "exited");
+      }
+    }
+  }
+}
+
+SCENARIO("trace: write")
+{
+  GIVEN("a scope is traced")
+  {
+    {
+      auto _ = threadable::details::trace_scope<>("traced", 42);
+    }
+    WHEN("written")
+    {
+      auto os = std::ostringstream{};
+      threadable::write_trace(os);
+      auto const json = os.str();
+      THEN("it's a chrome trace (with the event if enabled)")
+      {
+        REQUIRE(json.starts_with(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+        REQUIRE(json.ends_with("]}\n"));
+        auto const found = json.find(R"("name":"traced","ph":"X")") != std::string::npos;
+        REQUIRE(found == threadable::details::trace_enabled);
+      }
+    }
+  }
+}
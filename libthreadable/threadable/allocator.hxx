@@ -1,20 +1,101 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <new>
+#include <type_traits>
+
+#if __has_include(<sys/mman.h>)
+  #include <sys/mman.h>
+#endif
 
 namespace threadable
 {
+  // Pages backing (large) allocations.
+  enum class pages
+  {
+    normal,
+    huge // 2 MiB where supported (& available), else normal
+  };
+
+  namespace details
+  {
+    inline constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+    // Whole huge pages for allocations spanning at least one, nothing (0)
+    // otherwise or where not supported.
+    inline constexpr auto
+    huge_pages_size(std::size_t bytes) noexcept -> std::size_t
+    {
+#ifdef MAP_ANONYMOUS
+      if (bytes >= huge_page_size)
+      {
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+      }
+#endif
+      (void)bytes;
+      return 0;
+    }
+
+#ifdef MAP_ANONYMOUS
+    // Reserved huge pages if any (MAP_HUGETLB), else pages the kernel is
+    // asked to back by transparent huge pages.
+    inline auto
+    allocate_huge_pages(std::size_t bytes) -> void*
+    {
+      constexpr auto prot  = PROT_READ | PROT_WRITE;
+      constexpr auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  #ifdef MAP_HUGETLB
+      if (auto* p = ::mmap(nullptr, bytes, prot, flags | MAP_HUGETLB, -1, 0); p != MAP_FAILED)
+      {
+        return p;
+      }
+  #endif
+      auto* p = ::mmap(nullptr, bytes, prot, flags, -1, 0);
+      if (p == MAP_FAILED) [[unlikely]]
+      {
+        throw std::bad_alloc();
+      }
+  #ifdef MADV_HUGEPAGE
+      (void)::madvise(p, bytes, MADV_HUGEPAGE); // (only a hint)
+  #endif
+      return p;
+    }
+
+    inline void
+    deallocate_huge_pages(void* p, std::size_t bytes) noexcept
+    {
+      (void)::munmap(p, bytes);
+    }
+#endif
+  }
+
+  // Allocates with 'alignment' and, for 'pages::huge', backs allocations of
+  // at least a huge page by those (falling back to normal pages).
   template<typename T, std::size_t alignment>
   struct aligned_allocator : public std::allocator<T>
   {
     aligned_allocator() = default;
 
+    explicit aligned_allocator(pages kind) noexcept
+      : pages_(kind)
+    {}
+
+    template<typename U>
+    aligned_allocator(aligned_allocator<U, alignment> const& rhs) noexcept
+      : pages_(rhs.page_kind())
+    {}
+
     using base_t = std::allocator<T>;
     using base_t::base_t;
 
-    using pointer   = typename std::allocator_traits<base_t>::pointer;
-    using size_type = typename std::allocator_traits<base_t>::size_type;
+    using pointer         = typename std::allocator_traits<base_t>::pointer;
+    using size_type       = typename std::allocator_traits<base_t>::size_type;
+    using is_always_equal = std::false_type;
+    // (moved/swapped containers take the pages along, instead of reallocating
+    // element-wise when they differ)
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
 
     template<typename U>
     struct rebind
@@ -25,14 +106,46 @@ namespace threadable
     inline auto
     allocate(size_type n) -> pointer
     {
+#ifdef MAP_ANONYMOUS
+      if (auto const bytes = details::huge_pages_size(n * sizeof(T));
+          pages_ == pages::huge && bytes > 0)
+      {
+        static_assert(alignment <= details::huge_page_size);
+        return static_cast<pointer>(details::allocate_huge_pages(bytes));
+      }
+#endif
       return static_cast<pointer>(
         ::operator new[](n * sizeof(T), std::align_val_t(alignment))); // NOLINT
     }
 
     inline void
-    deallocate(pointer p, size_type) noexcept
+    deallocate(pointer p, size_type n) noexcept
     {
+#ifdef MAP_ANONYMOUS
+      if (auto const bytes = details::huge_pages_size(n * sizeof(T));
+          pages_ == pages::huge && bytes > 0)
+      {
+        details::deallocate_huge_pages(p, bytes);
+        return;
+      }
+#endif
+      (void)n;
       ::operator delete[](p, std::align_val_t{alignment}); // NOLINT
     }
+
+    [[nodiscard]] auto
+    page_kind() const noexcept -> pages
+    {
+      return pages_;
+    }
+
+    friend auto
+    operator==(aligned_allocator const& lhs, aligned_allocator const& rhs) noexcept -> bool
+    {
+      return lhs.pages_ == rhs.pages_;
+    }
+
+  private:
+    pages pages_ = pages::normal;
   };
 }
@@ -109,6 +109,12 @@ namespace threadable
       return *static_cast<invoke_func_t*>(static_cast<void*>(buf + header_size));
     }
 
+    inline constexpr auto
+    invoke_ptr(std::uint8_t const* buf) noexcept -> invoke_func_t
+    {
+      return *static_cast<invoke_func_t const*>(static_cast<void const*>(buf + header_size));
+    }
+
     inline constexpr void
     invoke_ptr(std::uint8_t* buf, invoke_func_t func) noexcept
     {
@@ -134,6 +140,12 @@ namespace threadable
       return buf + header_size + func_ptr_size + func_ptr_size;
     }
 
+    inline constexpr auto
+    body_ptr(std::uint8_t const* buf) noexcept -> std::uint8_t const*
+    {
+      return buf + header_size + func_ptr_size + func_ptr_size;
+    }
+
     inline constexpr void
     invoke(std::uint8_t* buf) noexcept
     {
@@ -580,6 +592,19 @@ namespace threadable
     {
       return buffer_.size();
     }
+
+    // the stored callable if it's a 'callable_t' (stored in place), else nullptr
+    template<typename callable_t>
+    [[nodiscard]] auto
+    target() const noexcept -> callable_t const*
+    {
+      if (!*this || details::invoke_ptr(buffer_.data()) !=
+                      std::addressof(details::invoke_func<std::remove_const_t<callable_t>>))
+      {
+        return nullptr;
+      }
+      return reinterpret_cast<callable_t const*>(details::body_ptr(buffer_.data())); // NOLINT
+    }
   };
 }
 
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace threadable
+{
+  namespace details
+  {
+    class atomic_histogram;
+  }
+
+  /*
+    Log-bucketed (HDR-style) histogram of durations.
+
+    Values are grouped by power of 2, each split into 8 linear sub-buckets,
+    so any recorded value is off by at most 12.5% (exact below 16ns) while
+    covering the full range of 64-bit nanoseconds in a fixed size.
+  */
+  class histogram
+  {
+  public:
+    static constexpr std::size_t sub_bucket_bits = 3;
+    static constexpr std::size_t sub_buckets     = 1 << sub_bucket_bits;
+    static constexpr std::size_t buckets         = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+    static constexpr auto
+    bucket(std::uint64_t value) noexcept -> std::size_t
+    {
+      if (value < sub_buckets)
+      {
+        return static_cast<std::size_t>(value);
+      }
+      auto const exp = static_cast<std::size_t>(std::bit_width(value)) - 1;
+      auto const sub = (value >> (exp - sub_bucket_bits)) & (sub_buckets - 1);
+      return (exp - sub_bucket_bits + 1) * sub_buckets + static_cast<std::size_t>(sub);
+    }
+
+    // highest value that ends up in 'index'
+    static constexpr auto
+    upper_bound(std::size_t index) noexcept -> std::uint64_t
+    {
+      if (index < sub_buckets)
+      {
+        return index;
+      }
+      auto const exp   = index / sub_buckets + sub_bucket_bits - 1;
+      auto const sub   = std::uint64_t{index % sub_buckets};
+      auto const width = std::uint64_t{1} << (exp - sub_bucket_bits);
+      return ((sub_buckets + sub) << (exp - sub_bucket_bits)) + width - 1;
+    }
+
+    void
+    record(std::chrono::nanoseconds duration, std::uint64_t n = 1) noexcept
+    {
+      auto const value =
+        static_cast<std::uint64_t>(std::max(duration, std::chrono::nanoseconds{0}).count());
+      counts_[bucket(value)] += n;
+      count_ += n;
+      sum_ += value * n;
+      max_ = std::max(max_, value);
+    }
+
+    void
+    merge(histogram const& rhs) noexcept
+    {
+      for (std::size_t i = 0; i < buckets; ++i)
+      {
+        counts_[i] += rhs.counts_[i];
+      }
+      count_ += rhs.count_;
+      sum_ += rhs.sum_;
+      max_ = std::max(max_, rhs.max_);
+    }
+
+    [[nodiscard]] auto
+    count() const noexcept -> std::uint64_t
+    {
+      return count_;
+    }
+
+    [[nodiscard]] auto
+    mean() const noexcept -> std::chrono::nanoseconds
+    {
+      return std::chrono::nanoseconds(count_ ? sum_ / count_ : 0);
+    }
+
+    [[nodiscard]] auto
+    max() const noexcept -> std::chrono::nanoseconds
+    {
+      return std::chrono::nanoseconds(max_);
+    }
+
+    // value that 'p' (0-1) of all recorded values are less than or equal to
+    [[nodiscard]] auto
+    percentile(double p) const noexcept -> std::chrono::nanoseconds
+    {
+      if (count_ == 0)
+      {
+        return std::chrono::nanoseconds{0};
+      }
+      auto const rank = std::max(std::uint64_t{1},
+                                 static_cast<std::uint64_t>(p * static_cast<double>(count_) + 0.5));
+      std::uint64_t seen = 0;
+      for (std::size_t i = 0; i < buckets; ++i)
+      {
+        if (seen += counts_[i]; seen >= rank)
+        {
+          return std::chrono::nanoseconds(std::min(upper_bound(i), max_));
+        }
+      }
+      return max();
+    }
+
+    void
+    write_text(std::ostream& os) const
+    {
+      os << "count: " << count() << ", mean: " << mean().count() << "ns, p50: "
+         << percentile(0.5).count() << "ns, p90: " << percentile(0.9).count()
+         << "ns, p99: " << percentile(0.99).count() << "ns, p999: " << percentile(0.999).count()
+         << "ns, max: " << max().count() << "ns";
+    }
+
+    // non-empty buckets are written as [upper bound (ns), count]
+    void
+    write_json(std::ostream& os) const
+    {
+      os << R"({"count":)" << count() << R"(,"mean_ns":)" << mean().count() << R"(,"p50_ns":)"
+         << percentile(0.5).count() << R"(,"p90_ns":)" << percentile(0.9).count()
+         << R"(,"p99_ns":)" << percentile(0.99).count() << R"(,"p999_ns":)"
+         << percentile(0.999).count() << R"(,"max_ns":)" << max().count() << R"(,"buckets":[)";
+      auto first = true;
+      for (std::size_t i = 0; i < buckets; ++i)
+      {
+        if (counts_[i] > 0)
+        {
+          os << (first ? "" : ",") << '[' << upper_bound(i) << ',' << counts_[i] << ']';
+          first = false;
+        }
+      }
+      os << "]}";
+    }
+
+  private:
+    friend class details::atomic_histogram;
+
+    std::array<std::uint64_t, buckets> counts_{};
+    std::uint64_t                      count_ = 0;
+    std::uint64_t                      sum_   = 0;
+    std::uint64_t                      max_   = 0;
+  };
+
+  namespace details
+  {
+    // Concurrently recordable histogram, read through (non-atomic) snapshots.
+    class atomic_histogram
+    {
+    public:
+      void
+      record(std::chrono::nanoseconds duration) noexcept
+      {
+        auto const value =
+          static_cast<std::uint64_t>(std::max(duration, std::chrono::nanoseconds{0}).count());
+        counts_[histogram::bucket(value)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        auto prev = max_.load(std::memory_order_relaxed);
+        while (prev < value && !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+          ;
+      }
+
+      [[nodiscard]] auto
+      snapshot() const noexcept -> histogram
+      {
+        histogram h;
+        for (std::size_t i = 0; i < histogram::buckets; ++i)
+        {
+          h.counts_[i] = counts_[i].load(std::memory_order_relaxed);
+          h.count_ += h.counts_[i];
+        }
+        h.sum_ = sum_.load(std::memory_order_relaxed);
+        h.max_ = max_.load(std::memory_order_relaxed);
+        return h;
+      }
+
+    private:
+      std::array<std::atomic_uint64_t, histogram::buckets> counts_{};
+      std::atomic_uint64_t                                 sum_{0};
+      std::atomic_uint64_t                                 max_{0};
+    };
+  }
+}
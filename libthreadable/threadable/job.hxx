@@ -2,8 +2,12 @@
 
 #include <threadable/atomic.hxx>
 #include <threadable/function.hxx>
+#include <threadable/probes.hxx>
 
 #include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <utility>
 
 #define FWD(...) ::std::forward<decltype(__VA_ARGS__)>(__VA_ARGS__)
 
@@ -20,6 +24,95 @@ namespace threadable
 
     static constexpr auto job_buffer_size =
       cache_line_size - sizeof(job_base) - sizeof(function<0>);
+
+    // Installed on threads executing jobs on behalf of a pool. Lets a waiting
+    // thread execute other pending jobs (eg. its own children) instead of
+    // blocking, which is what makes recursive fork-join possible without
+    // all workers ending up waiting on jobs that nobody is left to execute.
+    struct wait_helper
+    {
+      void* self                               = nullptr;
+      auto (*help)(void* self) -> bool         = nullptr;
+      // told when a job enters/leaves a blocking_region (optional)
+      void (*block)(void* self, bool blocking) = nullptr;
+
+      explicit operator bool() const noexcept
+      {
+        return help != nullptr;
+      }
+
+      // returns true if any pending work was executed
+      auto
+      operator()() const -> bool
+      {
+        return help(self);
+      }
+    };
+
+    inline thread_local wait_helper this_thread_helper; // NOLINT
+
+    // help attempts in a row finding nothing to execute before a waiting pool
+    // thread blocks instead (eg. when the awaited job is being executed)
+    static constexpr std::size_t fruitless_helps = 256;
+
+    // Index of the pool worker running on this thread, -1 on any other thread
+    // (eg. a scheduler or TBB thread). Passed to probes.
+    inline thread_local std::ptrdiff_t this_thread_worker = -1; // NOLINT
+
+    // Queue & slot of a token's job, only kept to identify it in probes (empty
+    // when they're compiled out).
+    template<bool enabled = THREADABLE_PROBES>
+    struct probe_id
+    {
+      void
+      set(void const* q, std::size_t s) noexcept
+      {
+        queue.store(q, std::memory_order_relaxed);
+        slot.store(s, std::memory_order_relaxed);
+      }
+
+      void
+      set(probe_id const& rhs) noexcept
+      {
+        set(rhs.queue.load(std::memory_order_relaxed), rhs.slot.load(std::memory_order_relaxed));
+      }
+
+      std::atomic<void const*> queue = nullptr;
+      std::atomic_size_t       slot  = 0;
+    };
+
+    template<>
+    struct probe_id<false>
+    {
+      void
+      set(void const*, std::size_t) noexcept
+      {}
+
+      void
+      set(probe_id const&) noexcept
+      {}
+    };
+
+    struct scoped_wait_helper
+    {
+      explicit scoped_wait_helper(wait_helper helper) noexcept
+        : prev_(std::exchange(this_thread_helper, helper))
+      {}
+
+      scoped_wait_helper(scoped_wait_helper const&) = delete;
+      scoped_wait_helper(scoped_wait_helper&&)      = delete;
+
+      ~scoped_wait_helper()
+      {
+        this_thread_helper = prev_;
+      }
+
+      auto operator=(scoped_wait_helper const&) -> scoped_wait_helper& = delete;
+      auto operator=(scoped_wait_helper&&) -> scoped_wait_helper&      = delete;
+
+    private:
+      wait_helper prev_;
+    };
   }
 
   enum job_state : std::uint8_t
@@ -106,6 +199,12 @@ namespace threadable
       return func_;
     }
 
+    auto
+    get() const noexcept -> auto const&
+    {
+      return func_;
+    }
+
   private:
     function_t func_;
   };
@@ -128,6 +227,7 @@ namespace threadable
       : cancelled_(rhs.cancelled_.load(std::memory_order_acquire))
       , state_(rhs.state_.load(std::memory_order_acquire))
     {
+      id_.set(rhs.id_);
       rhs.state_.store(nullptr, std::memory_order_release);
     }
 
@@ -137,14 +237,18 @@ namespace threadable
     operator=(job_token&& rhs) noexcept -> auto&
     {
       cancelled_.store(rhs.cancelled_, std::memory_order_release);
+      id_.set(rhs.id_);
       state_.store(rhs.state_, std::memory_order_release);
       rhs.state_.store(nullptr, std::memory_order_release);
       return *this;
     }
 
+    // 'queue' & 'slot' of the job only identify it in probes (dropped when
+    // they're compiled out)
     void
-    reassign(atomic_bitfield_t& state) noexcept
+    reassign(atomic_bitfield_t& state, void const* queue = nullptr, std::size_t slot = 0) noexcept
     {
+      id_.set(queue, slot);
       state_.store(&state, std::memory_order_release);
     }
 
@@ -169,6 +273,50 @@ namespace threadable
 
     void
     wait() noexcept
+    {
+      THREADABLE_PROBE4(wait_enter, this, id_.queue.load(std::memory_order_relaxed),
+                        id_.slot.load(std::memory_order_relaxed), details::this_thread_worker);
+      // help out with pending jobs while waiting if this thread belongs to a pool,
+      // until there's been nothing to help with for a while
+      if (auto const& helper = details::this_thread_helper; helper) [[unlikely]]
+      {
+        for (std::size_t fruitless = 0; !done() && fruitless < details::fruitless_helps;)
+        {
+          if (helper())
+          {
+            fruitless = 0;
+          }
+          else
+          {
+            ++fruitless;
+            std::this_thread::yield();
+          }
+        }
+        if (!done())
+        {
+          // blocked like in a blocking_region (the pool may compensate for it)
+          if (helper.block)
+          {
+            helper.block(helper.self, true);
+          }
+          block();
+          if (helper.block)
+          {
+            helper.block(helper.self, false);
+          }
+        }
+      }
+      else
+      {
+        block();
+      }
+      THREADABLE_PROBE4(wait_exit, this, id_.queue.load(std::memory_order_relaxed),
+                        id_.slot.load(std::memory_order_relaxed), details::this_thread_worker);
+    }
+
+  private:
+    void
+    block() noexcept
     {
       // take into account that the underlying state-ptr might have
       // been re-assigned while waiting (eg. for a recursive/self-queueing job)
@@ -188,9 +336,9 @@ namespace threadable
       }
     }
 
-  private:
     details::atomic_flag_t          cancelled_ = false;
     std::atomic<atomic_bitfield_t*> state_     = nullptr;
+    [[no_unique_address]] details::probe_id<> id_;
   };
 
   static_assert(std::move_constructible<job_token>);
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <threadable/job.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define FWD(...) ::std::forward<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace threadable::details
+{
+  inline constexpr std::size_t local_queue_size = 1 << 8;
+
+  /*
+    Private LIFO buffer of jobs spawned from a thread executing pool jobs.
+
+    Only the owning thread pushes & pops, so apart from the job state itself
+    (needed by tokens) there is no synchronization. Jobs are executed in place,
+    also when handed off ("donated") to an idle worker, so a slot is only
+    reused once its job is done.
+  */
+  class local_queue
+  {
+    using index_t                    = std::uint32_t;
+    static constexpr auto index_mask = local_queue_size - 1u;
+
+    static_assert((local_queue_size & index_mask) == 0, "size must be a power of 2");
+
+    static constexpr auto
+    mask(std::size_t index) noexcept
+    {
+      return index & index_mask;
+    }
+
+  public:
+    local_queue() = default;
+
+    local_queue(local_queue const&) = delete;
+    local_queue(local_queue&&)      = delete;
+
+    ~local_queue()
+    {
+      (void)execute();
+      // wait for donated jobs still executing in place
+      for (auto& job : jobs_)
+      {
+        details::wait<job_state::active, true>(job.state, std::memory_order_acquire);
+      }
+    }
+
+    auto operator=(local_queue const&) -> local_queue& = delete;
+    auto operator=(local_queue&&) -> local_queue&      = delete;
+
+    // returns false if no slot is available
+    template<std::copy_constructible callable_t, typename... arg_ts>
+      requires std::invocable<callable_t, arg_ts...>
+    auto
+    push(job_token& token, callable_t&& func, arg_ts&&... args) noexcept -> bool
+    {
+      if (size() == local_queue_size)
+      {
+        return false;
+      }
+
+      // slots are freed out of order (jobs might be executing further down
+      // the stack, or have been donated) so probe for one that is done.
+      for (std::size_t i = 0; i < local_queue_size; ++i)
+      {
+        auto const slot = next_++;
+        if (auto& job = jobs_[mask(slot)]; !job)
+        {
+          job.set(FWD(func), FWD(args)...);
+          token.reassign(job.state, this, mask(slot));
+          pending_[mask(bottom_++)] = static_cast<index_t>(mask(slot));
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // newest pending job, or nullptr if empty
+    auto
+    pop() noexcept -> job*
+    {
+      return empty() ? nullptr : &jobs_[pending_[mask(--bottom_)]];
+    }
+
+    // oldest pending job, or nullptr if empty
+    auto
+    donate() noexcept -> job*
+    {
+      return empty() ? nullptr : &jobs_[pending_[mask(top_++)]];
+    }
+
+    // executes pending jobs (including any they push) in LIFO order
+    auto
+    execute() -> std::size_t
+    {
+      std::size_t n = 0;
+      while (auto* job = pop())
+      {
+        (*job)();
+        ++n;
+      }
+      return n;
+    }
+
+    [[nodiscard]] auto
+    size() const noexcept -> std::size_t
+    {
+      return bottom_ - top_;
+    }
+
+    // true once all jobs pushed have been executed (including donated ones)
+    [[nodiscard]] auto
+    done() const noexcept -> bool
+    {
+      return empty() && std::ranges::all_of(jobs_,
+                                            [](job const& job)
+                                            {
+                                              return job.done();
+                                            });
+    }
+
+    [[nodiscard]] auto
+    empty() const noexcept -> bool
+    {
+      return top_ == bottom_;
+    }
+
+    static constexpr auto
+    max_size() noexcept -> std::size_t
+    {
+      return local_queue_size;
+    }
+
+    // bytes per thread (every one executing pool jobs has one)
+    static constexpr auto
+    memory_usage() noexcept -> std::size_t
+    {
+      return sizeof(local_queue) + local_queue_size * sizeof(job);
+    }
+
+  private:
+    std::size_t top_    = 0; // oldest pending (donated first)
+    std::size_t bottom_ = 0; // newest pending (popped first)
+    std::size_t next_   = 0; // next slot to probe
+
+    std::array<index_t, local_queue_size> pending_{};
+    std::vector<job>                      jobs_ = std::vector<job>(local_queue_size);
+  };
+
+  inline auto
+  this_thread_jobs() -> local_queue&
+  {
+    thread_local local_queue jobs; // NOLINT
+    return jobs;
+  }
+}
+
+#undef FWD
@@ -1,125 +1,119 @@
 #pragma once
 
 #include <threadable/function.hxx>
+#include <threadable/probes.hxx>
 #include <threadable/queue.hxx>
+#include <threadable/scheduling.hxx>
+#include <threadable/stats.hxx>
 #include <threadable/std_concepts.hxx>
+#include <threadable/trace.hxx>
 
 #include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <limits>
 #include <mutex>
-#include <random>
+#include <span>
+#include <string>
 #include <thread>
 
 #define FWD(...) ::std::forward<decltype(__VA_ARGS__)>(__VA_ARGS__)
 
 namespace threadable
 {
-  template<std::size_t max_nr_of_jobs = details::default_max_nr_of_jobs>
+  // Number of workers (including the scheduler thread) a pool keeps running.
+  // When 'min_workers' differs from 'max_workers' threads are spawned and
+  // retired based on load.
+  struct elasticity
+  {
+    unsigned int min_workers = 2;
+    unsigned int max_workers = std::thread::hardware_concurrency();
+    // grow when no worker is idle & more than this many ranges, or this much
+    // (estimated) work, wait per worker
+    std::size_t               grow_backlog = 4;
+    std::chrono::microseconds grow_work    = std::chrono::microseconds{1000};
+    // retire a worker after being idle for this long
+    std::chrono::milliseconds idle_timeout = std::chrono::milliseconds{1000};
+    // minimum time between two resizes
+    std::chrono::milliseconds cooldown = std::chrono::milliseconds{10};
+    // extra workers started (on top of 'max_workers') to compensate for jobs
+    // waiting inside a 'blocking_region'
+    unsigned int max_compensation = std::thread::hardware_concurrency();
+  };
+
+  // Which workers execute the ranges of a queue.
+  enum class affinity
+  {
+    none,  // any (picked by the pool's scheduling policy)
+    sticky // the same one (keeping caches warm), unless it's overloaded
+  };
+
+  template<std::size_t max_nr_of_jobs = details::default_max_nr_of_jobs,
+           scheduling::policy policy_t = scheduling::random>
   class pool
   {
-    using clk_t = std::chrono::high_resolution_clock;
+    using clk_t = std::chrono::steady_clock;
+
+    // estimated work pending for a worker above which ranges of queues with
+    // 'affinity::sticky' spill over to other workers
+    static constexpr auto sticky_overload_ns = std::size_t{1'000'000};
 
   public:
     using queue_t = queue<max_nr_of_jobs>;
 
     struct alignas(details::cache_line_size) worker
     {
-      std::thread thread;
-      queue_t     work;
+      std::thread             thread;
+      std::mutex              mutex; // guards consuming 'work' (owner & helping threads)
+      std::atomic_bool        idle   = false;
+      std::atomic_bool        retire = false;
+      std::atomic_bool        left   = false; // thread is done (once retired), can be joined
+      std::atomic<clk_t::rep> idleSince{0};
+      std::atomic_size_t      pendingNs{0}; // estimated work dispatched & not yet executed
+      queue_t                 work;
+      [[no_unique_address]] details::worker_counters<> stats;
     };
 
-    using queues_t = std::vector<std::shared_ptr<queue_t>>;
-
     pool(unsigned int workers = std::thread::hardware_concurrency()) noexcept
+      : pool(elasticity{.min_workers = workers, .max_workers = workers})
+    {}
+
+    explicit pool(elasticity elastic, policy_t policy = {}) noexcept
+      : elastic_(elastic)
+      , policy_(std::move(policy))
     {
-      workers = std::max(2u, workers);
+      elastic_.min_workers = std::max(2u, elastic_.min_workers);
+      elastic_.max_workers = std::max(elastic_.min_workers, elastic_.max_workers);
       details::atomic_clear(quit_);
 
-      // start worker threads
-      for (std::size_t i = 0; i < workers - 1; ++i)
+      // start worker threads (scheduler thread counts as one)
+      workers_.resize(elastic_.max_workers - 1 + elastic_.max_compensation);
+      for (std::size_t i = 0; i < elastic_.min_workers - 1; ++i)
       {
-        auto w    = std::make_unique<worker>();
-        w->thread = std::thread(
-          [](std::atomic_bool& quit, queue_t& work)
-          {
-            while (true)
-            {
-              // 1. Check if quit = true. If so, bail.
-              if (details::atomic_test(quit, std::memory_order_acquire)) [[unlikely]]
-              {
-                break;
-              }
-              // 2. Wait for jobs to ready.
-              else [[likely]]
-              {
-                work.wait();
-              }
-              // 3. Execute all jobs.
-              work.execute();
-            }
-          },
-          std::ref(quit_), std::ref(w->work));
-        workers_.push_back(std::move(w));
+        grow();
       }
 
       // start scheduler thread
       scheduler_ = std::thread(
         [this]
         {
-          auto rd    = std::random_device{};
-          auto gen   = std::mt19937(rd());
-          auto distr = std::uniform_int_distribution<std::size_t>(std::size_t{0}, workers_.size());
-
+          details::this_thread_helper = helper();
+          details::trace_thread_name("scheduler");
           while (true)
           {
             // 1. Check if quit = true. If so, bail.
             // 2. Distribute queues to workers.
+            // 3. Grow/shrink number of workers.
             if (details::atomic_test(quit_, std::memory_order_acquire)) [[unlikely]]
             {
               break;
             }
-
-            queues_t queues;
-            {
-              auto _ = std::scoped_lock{queueMutex_};
-              queues = queues_;
-            }
-
-            auto rand = distr(gen);
-            if (queues.size() == 1)
-            {
-              (void)queues[0]->execute();
-            }
-            else
-            {
-              for (auto& queue : queues)
-              {
-                if (auto range = queue->consume(); !range.empty())
-                {
-                  // assign to (random) worker
-                  // @TODO: Implement a proper load balancer.
-                  if (rand < workers_.size()) [[likely]]
-                  {
-                    worker& w = *workers_[rand];
-                    w.work.push(
-                      [queue, range = std::move(range)]
-                      {
-                        queue->execute(range);
-                      });
-                  }
-                  else [[unlikely]]
-                  {
-                    queue->execute(range);
-                  }
-                  auto prev = rand;
-                  while ((rand = distr(gen)) != prev)
-                    ;
-                }
-              }
-            }
+            schedule();
+            balance();
+            stats_.schedulerIterations.add();
           }
+          settle();
         });
     }
 
@@ -137,50 +131,117 @@ namespace threadable
       {
         scheduler_.join();
       }
+      // no compensation workers are started once quit is set
+      {
+        auto _ = std::scoped_lock{resizeMutex_};
+      }
+
+      for (auto& w : allocated())
+      {
+        if (w->thread.joinable())
+        {
+          w->work.push([] {});
+          w->thread.join();
+        }
+      }
+      // anything pushed (eg. spawned) to workers that had left already
+      for (auto& w : allocated())
+      {
+        (void)w->work.execute();
+      }
+    }
+
+    // Push a job from within a running job. Jobs spawned from a thread executing
+    // pool jobs go to that thread's private LIFO buffer (no atomics in the common
+    // case) and execute when the spawning job waits or finishes, unless handed off
+    // to an idle worker. Elsewhere (or when full) it's handed to a worker directly.
+    template<std::copy_constructible callable_t, typename... arg_ts>
+      requires std::invocable<callable_t, arg_ts...>
+    [[nodiscard]] auto
+    spawn(callable_t&& func, arg_ts&&... args) noexcept -> job_token
+    {
+      job_token token;
+      if (details::this_thread_helper) [[likely]]
+      {
+        auto& local = details::this_thread_jobs();
+        if (local.push(token, FWD(func), FWD(args)...)) [[likely]]
+        {
+          // keep the newest for this thread, give the oldest away (unless
+          // workers are leaving)
+          if (local.size() > 1 && idle_.load(std::memory_order_relaxed) > 0 &&
+              !details::atomic_test(quit_, std::memory_order_acquire)) [[unlikely]]
+          {
+            if (auto* w = claim_idle(); w)
+            {
+              w->work.push(
+                [job = local.donate()]
+                {
+                  (*job)();
+                });
+            }
+          }
+          return token;
+        }
+      }
 
-      for (auto& w : workers_)
+      auto* w = claim_idle();
+      if (!w)
       {
-        w->work.push([] {});
-        w->thread.join();
+        auto const workers = running();
+        w = workers[nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers.size()].get();
       }
+      w->work.push(token, FWD(func), FWD(args)...); // NOLINT (only forwarded once)
+      return token;
     }
 
     [[nodiscard]] auto
-    create(execution_policy policy = execution_policy::parallel) noexcept -> queue_t&
+    create(execution_policy policy    = execution_policy::parallel,
+           affinity         placement = affinity::none,
+           pages            kind      = pages::normal) noexcept -> queue_t&
     {
-      return add(queue_t(policy));
+      return add(queue_t(policy, kind), placement);
     }
 
     [[nodiscard]] auto
-    add(queue_t&& q) -> queue_t&
+    add(queue_t&& q, affinity placement = affinity::none) -> queue_t&
     {
       queue_t* queue = nullptr;
       {
         auto _ = std::scoped_lock{queueMutex_};
-        queue  = queues_.emplace_back(std::make_unique<queue_t>(std::move(q))).get();
+        queue  = &queues_.emplace_back(std::make_unique<entry>(std::move(q), placement))->queue;
+        queuesVersion_.fetch_add(1, std::memory_order_release);
       }
 
       return *queue;
     }
 
+    // Destroys the queue, or once the ranges of it that are being executed
+    // have finished.
     [[nodiscard]] auto
     remove(queue_t&& queue) noexcept -> bool // NOLINT
     {
-      auto _ = std::scoped_lock{queueMutex_};
-      if (auto itr = std::find_if(std::begin(queues_), std::end(queues_),
-                                  [&queue](auto const& q)
-                                  {
-                                    return q.get() == &queue;
-                                  });
-          itr != std::end(queues_))
+      std::unique_ptr<entry> removed;
       {
+        auto _ = std::scoped_lock{schedulerMutex_, queueMutex_};
+        auto itr = std::find_if(std::begin(queues_), std::end(queues_),
+                                [&queue](auto const& e)
+                                {
+                                  return &e->queue == &queue;
+                                });
+        if (itr == std::end(queues_))
+        {
+          return false;
+        }
+        removed = std::move(*itr);
         queues_.erase(itr);
-        return true;
-      }
-      else
-      {
-        return false;
+        queuesVersion_.fetch_add(1, std::memory_order_release);
+        if (removed->executing.load(std::memory_order_acquire) > 0) [[unlikely]]
+        {
+          removed_.push_back(std::move(removed));
+          pendingRemoval_ = true;
+        }
       }
+      return true;
     }
 
     [[nodiscard]] auto
@@ -190,6 +251,79 @@ namespace threadable
       return queues_.size();
     }
 
+    // Snapshot of counters, read while running (so not necessarily consistent
+    // between counters). All zero unless compiled with THREADABLE_STATS.
+    [[nodiscard]] auto
+    stats() const -> pool_stats
+    {
+      pool_stats stats;
+      stats.scheduler_iterations = stats_.schedulerIterations.load();
+      stats.dispatched           = stats_.dispatched.load();
+      stats.helped               = stats_.helped.load();
+      {
+        auto _ = std::scoped_lock{queueMutex_};
+        stats.queues.reserve(queues_.size());
+        for (auto const& e : queues_)
+        {
+          stats.queues.push_back(e->queue.stats());
+        }
+      }
+      for (auto const& w : running())
+      {
+        stats.workers.push_back(w->stats.snapshot());
+      }
+      return stats;
+    }
+
+    // Job latencies merged over all queues (not counting jobs spawned from
+    // within jobs). Empty unless compiled with THREADABLE_LATENCY.
+    [[nodiscard]] auto
+    latency() const -> latency_stats
+    {
+      latency_stats latency;
+      auto          _ = std::scoped_lock{queueMutex_};
+      for (auto const& e : queues_)
+      {
+        auto const q = e->queue.latency();
+        latency.queued.merge(q.queued);
+        latency.run.merge(q.run);
+      }
+      return latency;
+    }
+
+    // Bytes allocated by the pool: queues, workers (each with a queue of its
+    // own) & the spawn buffer of every running thread. Excludes thread stacks.
+    [[nodiscard]] auto
+    memory_usage() const -> std::size_t
+    {
+      constexpr auto per_thread = details::local_queue::memory_usage();
+
+      auto bytes = sizeof(pool) + workers_.capacity() * sizeof(workers_[0]) + per_thread;
+      for (auto const& w : allocated())
+      {
+        bytes += sizeof(worker) - sizeof(queue_t) + w->work.memory_usage();
+      }
+      bytes += running().size() * per_thread;
+
+      auto _ = std::scoped_lock{queueMutex_};
+      bytes += (queues_.capacity() + removed_.capacity()) * sizeof(typename queues_t::value_type);
+      for (auto const* queues : {&queues_, &removed_})
+      {
+        for (auto const& e : *queues)
+        {
+          bytes += sizeof(entry) - sizeof(queue_t) + e->queue.memory_usage();
+        }
+      }
+      return bytes;
+    }
+
+    // number of running threads (including the scheduler thread)
+    [[nodiscard]] auto
+    workers() const noexcept -> std::size_t
+    {
+      return running_.load(std::memory_order_acquire) + 1;
+    }
+
     [[nodiscard]] auto
     size() const noexcept -> std::size_t
     {
@@ -208,11 +342,681 @@ namespace threadable
     }
 
   private:
+    // A queue & the number of its ranges being executed outside of
+    // 'schedulerMutex_' (by workers, inline or by helping threads). Once
+    // removed, it's destroyed when that drops to zero.
+    //
+    // NOTE: 'executing' is what makes 'remove()' safe, not an ownership count:
+    //       a handed off range only holds a raw 'entry*' & may sit in a
+    //       worker's queue (to be run by it or by any thread helping) long
+    //       after the scheduler moved on, so no thread's epoch/version tells
+    //       when the last one is done with it. It's touched once per range (not
+    //       per job): incremented by the scheduler (the only one dispatching),
+    //       decremented by whoever finishes the range, on a line of its own. So
+    //       it's at most contended by as many threads as there are ranges of
+    //       the queue in flight, which the chunk size keeps coarse.
+    struct entry
+    {
+      entry(queue_t&& q, affinity placement) noexcept
+        : queue(std::move(q))
+        , placement(placement)
+      {}
+
+      queue_t     queue;
+      affinity    placement;
+      std::size_t preferred = std::numeric_limits<std::size_t>::max(); // (sticky) worker index
+      alignas(details::cache_line_size) std::atomic_size_t executing{0};
+    };
+
+    using queues_t = std::vector<std::unique_ptr<entry>>;
+
+    // A consumed range handed over for execution, see 'handoff()'. Indices
+    // instead of iterators & no ownership, so dispatching it to a worker fits
+    // in a job (no allocation or reference counting).
+    struct range_handoff
+    {
+      auto
+      operator()() const -> std::size_t
+      {
+        auto const n = owner->queue.execute(owner->queue.range(first, last));
+        if (pendingNs) [[likely]]
+        {
+          pendingNs->fetch_sub(workNs, std::memory_order_relaxed);
+        }
+        owner->executing.fetch_sub(1, std::memory_order_release);
+        return n;
+      }
+
+      entry*              owner;
+      std::size_t         first;
+      std::size_t         last;
+      std::atomic_size_t* pendingNs; // of the worker it's dispatched to
+      std::size_t         workNs;
+    };
+
+    static_assert(required_buffer_size_v<range_handoff> <= details::job_buffer_size,
+                  "dispatching a range must not allocate");
+
+    // Requires 'schedulerMutex_' (keeping 'e' from being destroyed meanwhile).
+    // When dispatched to a worker its estimated work is added to the worker's
+    // pending work until executed.
+    static auto
+    handoff(entry& e, auto const& range, worker* w = nullptr) noexcept -> range_handoff
+    {
+      e.executing.fetch_add(1, std::memory_order_relaxed);
+      auto const workNs = w ? expected_work(e, range.size()) : 0;
+      if (w)
+      {
+        w->pendingNs.fetch_add(workNs, std::memory_order_relaxed);
+      }
+      return {&e, range.begin().index(), range.end().index(), w ? &w->pendingNs : nullptr,
+              workNs};
+    }
+
+    // Worker index to dispatch a range of 'e' to, given the policy's pick. For a
+    // sticky queue that's its preferred worker (picked round-robin at first or
+    // if retired) unless overloaded, then the range spills over to the pick.
+    // Requires 'schedulerMutex_'.
+    auto
+    target(entry& e, std::size_t pick) noexcept -> std::size_t
+    {
+      if (e.placement != affinity::sticky)
+      {
+        return pick;
+      }
+      auto const workers = running();
+      if (e.preferred >= workers.size()) [[unlikely]]
+      {
+        e.preferred = nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers.size();
+      }
+      if (workers[e.preferred]->pendingNs.load(std::memory_order_relaxed) > sticky_overload_ns)
+        [[unlikely]]
+      {
+        return pick;
+      }
+      return e.preferred;
+    }
+
+    // (the scheduler thread when out of range)
+    static auto
+    load(std::span<std::unique_ptr<worker> const> workers, std::size_t i) noexcept
+      -> scheduling::load
+    {
+      if (i >= workers.size()) [[unlikely]]
+      {
+        return scheduling::load::max();
+      }
+      return {.ranges  = workers[i]->work.size(),
+              .work_ns = workers[i]->pendingNs.load(std::memory_order_relaxed)};
+    }
+
+    // estimated time to execute 'n' jobs of 'e' (at least 1ns per job)
+    static auto
+    expected_work(entry const& e, std::size_t n) noexcept -> std::size_t
+    {
+      return n * std::max(static_cast<std::size_t>(e.queue.cost().count()), std::size_t{1});
+    }
+
+    // Hands chunks (sized by the policy) from the front of a range to idle
+    // workers & returns what's left. Ranges of sequential queues aren't split
+    // (the chunks would wait on each other).
+    auto
+    split(entry& e, auto range) -> decltype(range)
+    {
+      if (e.queue.policy() != execution_policy::parallel)
+      {
+        return range;
+      }
+      auto const chunk = static_cast<std::ptrdiff_t>(policy_.chunk(e.queue.cost()));
+      if (chunk == 0)
+      {
+        return range;
+      }
+      auto const workers = running();
+      for (std::size_t i = 0; i < workers.size() && std::ranges::ssize(range) >= 2 * chunk &&
+                              idle_.load(std::memory_order_relaxed) > 0;
+           ++i)
+      {
+        auto& w = *workers[i];
+        if (w.idle.load(std::memory_order_relaxed) &&
+            w.idle.exchange(false, std::memory_order_acq_rel))
+        {
+          idle_.fetch_sub(1, std::memory_order_relaxed);
+          auto const mid = std::ranges::next(range.begin(), chunk);
+          auto       _   = details::trace_scope<>("dispatch", i);
+          stats_.dispatched.add();
+          THREADABLE_PROBE3(dispatch, &e.queue, i, chunk);
+          w.work.push(handoff(e, std::ranges::subrange(range.begin(), mid), &w));
+          range = {mid, range.end()};
+        }
+      }
+      return range;
+    }
+
+    // Queues to schedule, copied from 'queues_' when added or removed (valid
+    // while holding 'schedulerMutex_'). Also destroys removed queues that are
+    // no longer being executed.
+    auto
+    scheduled() -> std::span<entry* const>
+    {
+      if (queuesVersion_.load(std::memory_order_acquire) != scheduledVersion_ || pendingRemoval_)
+        [[unlikely]]
+      {
+        queues_t reclaimed; // destroyed after unlocking
+        auto     _ = std::scoped_lock{queueMutex_};
+        scheduledVersion_ = queuesVersion_.load(std::memory_order_relaxed);
+        scheduled_.clear();
+        for (auto const& e : queues_)
+        {
+          scheduled_.push_back(e.get());
+        }
+        for (auto& e : removed_)
+        {
+          if (e->executing.load(std::memory_order_acquire) == 0)
+          {
+            reclaimed.push_back(std::move(e));
+          }
+        }
+        std::erase(removed_, nullptr);
+        pendingRemoval_ = !removed_.empty();
+      }
+      return scheduled_;
+    }
+
+    auto
+    helper() noexcept -> details::wait_helper
+    {
+      return {this,
+              [](void* self)
+              {
+                return static_cast<pool*>(self)->help();
+              },
+              [](void* self, bool blocking)
+              {
+                static_cast<pool*>(self)->block(blocking);
+              }};
+    }
+
+    // workers with a running thread
+    auto
+    running() const noexcept -> std::span<std::unique_ptr<worker> const>
+    {
+      return {workers_.data(), running_.load(std::memory_order_acquire)};
+    }
+
+    // workers that have been started at some point (might be retired)
+    auto
+    allocated() const noexcept -> std::span<std::unique_ptr<worker> const>
+    {
+      return {workers_.data(), allocated_.load(std::memory_order_acquire)};
+    }
+
+    void
+    grow()
+    {
+      auto const i = running_.load(std::memory_order_relaxed);
+      if (!workers_[i])
+      {
+        workers_[i] = std::make_unique<worker>();
+        allocated_.store(i + 1, std::memory_order_release);
+      }
+
+      auto& w = *workers_[i];
+      if (w.thread.joinable()) [[unlikely]]
+      {
+        // retired & not reaped yet (it's leaving)
+        w.thread.join();
+      }
+      w.retire.store(false, std::memory_order_relaxed);
+      w.left.store(false, std::memory_order_relaxed);
+      w.thread = std::thread(
+        [this, i](worker& w)
+        {
+          details::this_thread_helper = helper();
+          details::this_thread_worker = static_cast<std::ptrdiff_t>(i);
+          details::trace_thread_name("worker " + std::to_string(i));
+          while (true)
+          {
+            // 1. Check if quit or retire = true. If so, bail.
+            if (details::atomic_test(quit_, std::memory_order_acquire) ||
+                w.retire.load(std::memory_order_acquire)) [[unlikely]]
+            {
+              break;
+            }
+            // 2. Wait for jobs to ready.
+            auto       lock      = std::unique_lock{w.mutex};
+            auto const idleSince = clk_t::now();
+            w.idleSince.store(idleSince.time_since_epoch().count(), std::memory_order_relaxed);
+            w.idle.store(true, std::memory_order_release);
+            idle_.fetch_add(1, std::memory_order_relaxed);
+            w.work.wait();
+            if (w.idle.exchange(false, std::memory_order_acq_rel))
+            {
+              idle_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            auto range = w.work.consume();
+            lock.unlock();
+            // 3. Execute all jobs.
+            if constexpr (details::stats_enabled)
+            {
+              auto const busySince = clk_t::now();
+              w.stats.wakeups.add();
+              w.stats.idleNs.add(static_cast<std::size_t>((busySince - idleSince).count()));
+              w.stats.executed.add(w.work.execute(range));
+              w.stats.busyNs.add(static_cast<std::size_t>((clk_t::now() - busySince).count()));
+            }
+            else
+            {
+              (void)w.work.execute(range);
+            }
+          }
+          // 4. Execute anything pushed before leaving.
+          {
+            auto _ = std::scoped_lock{w.mutex};
+            (void)w.work.execute();
+          }
+          settle();
+          w.left.store(true, std::memory_order_release);
+        },
+        std::ref(w));
+
+      running_.store(i + 1, std::memory_order_release);
+      lastResize_ = clk_t::now();
+    }
+
+    // Called by a pool thread before it exits. Jobs it donated execute in place
+    // (in its spawn buffer), so wait for those to finish. Helps out meanwhile,
+    // which also executes donations to workers that have left already.
+    void
+    settle()
+    {
+      auto& local = details::this_thread_jobs();
+      (void)local.execute();
+      while (!local.done())
+      {
+        if (!help())
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+
+    auto
+    elastic() const noexcept -> bool
+    {
+      return elastic_.min_workers != elastic_.max_workers;
+    }
+
+    // max number of running threads, raised while jobs are blocked
+    auto
+    capacity() const noexcept -> std::size_t
+    {
+      return elastic_.max_workers + std::min<std::size_t>(blocked_.load(std::memory_order_acquire),
+                                                          elastic_.max_compensation);
+    }
+
+    // Called when a job enters/leaves a blocking_region. Starts a compensation
+    // worker right away (the scheduler might be the one blocked), which is
+    // retired by balance() once idle for 'idle_timeout' after unblocking.
+    void
+    block(bool blocking)
+    {
+      if (!blocking)
+      {
+        blocked_.fetch_sub(1, std::memory_order_acq_rel);
+        return;
+      }
+
+      blocked_.fetch_add(1, std::memory_order_acq_rel);
+      auto _ = std::scoped_lock{resizeMutex_};
+      if (details::atomic_test(quit_, std::memory_order_acquire)) [[unlikely]]
+      {
+        return;
+      }
+      if (running_.load(std::memory_order_relaxed) + 1 < capacity())
+      {
+        grow();
+      }
+      // the blocked job might be executing inline on (or for) the scheduler
+      // thread, so let a worker keep dispatching meanwhile
+      if (executingInline_.load(std::memory_order_acquire) > 0 &&
+          !standingIn_.exchange(true, std::memory_order_acq_rel))
+      {
+        auto* w = claim_idle();
+        if (!w)
+        {
+          w = running().back().get();
+        }
+        w->work.push(
+          [this, w]
+          {
+            stand_in(*w);
+          });
+      }
+    }
+
+    // schedules on behalf of the scheduler thread until it's back
+    void
+    stand_in(worker const& self)
+    {
+      while (!details::atomic_test(quit_, std::memory_order_acquire) &&
+             executingInline_.load(std::memory_order_acquire) > 0 &&
+             blocked_.load(std::memory_order_acquire) > 0)
+      {
+        schedule(&self);
+      }
+      standingIn_.store(false, std::memory_order_release);
+    }
+
+    // Retires the last running worker, which must be idle & claimed. Its thread
+    // is joined once it has left, see 'reap()'. Requires 'resizeMutex_'.
+    void
+    shrink()
+    {
+      auto const i = running_.load(std::memory_order_relaxed) - 1;
+      auto&      w = *workers_[i];
+      running_.store(i, std::memory_order_release);
+
+      w.retire.store(true, std::memory_order_release);
+      w.work.push([] {});
+      lastResize_ = clk_t::now();
+    }
+
+    // Joins the threads of retired workers that have left (without waiting on
+    // any still leaving). Requires 'resizeMutex_'.
+    void
+    reap()
+    {
+      for (auto const& w : allocated().subspan(running().size()))
+      {
+        if (w->thread.joinable() && w->left.load(std::memory_order_acquire))
+        {
+          w->thread.join();
+        }
+      }
+    }
+
+    // Called by the scheduler thread. Grows when all workers are busy & have
+    // work piling up, shrinks when the last worker has been idle for too long
+    // (never below 'min_workers' + blocked jobs). The thresholds differ and
+    // resizes are rate-limited to avoid thrashing.
+    void
+    balance()
+    {
+      // work pushed to a retired worker (by a thread that saw it running)
+      for (auto const& w : allocated().subspan(running().size()))
+      {
+        if (!w->work.empty()) [[unlikely]]
+        {
+          auto _ = std::scoped_lock{w->mutex};
+          (void)w->work.execute();
+        }
+      }
+
+      // fixed size, unless compensating for blocked jobs
+      if (!elastic() && running().size() + 1 <= elastic_.max_workers) [[likely]]
+      {
+        return;
+      }
+
+      auto lock = std::unique_lock{resizeMutex_, std::try_to_lock};
+      if (!lock)
+      {
+        return;
+      }
+      reap();
+
+      auto const now = clk_t::now();
+      if (now - lastResize_ < elastic_.cooldown)
+      {
+        return;
+      }
+
+      auto const workers = running();
+      if (elastic() && workers.size() + 1 < capacity() &&
+          idle_.load(std::memory_order_relaxed) == 0)
+      {
+        std::size_t backlog   = 0;
+        std::size_t pendingNs = 0;
+        for (auto const& w : workers)
+        {
+          backlog += w->work.size();
+          pendingNs += w->pendingNs.load(std::memory_order_relaxed);
+        }
+        auto const growWorkNs = static_cast<std::size_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elastic_.grow_work).count());
+        if (backlog > elastic_.grow_backlog * workers.size() ||
+            pendingNs > growWorkNs * workers.size())
+        {
+          grow();
+          return;
+        }
+      }
+
+      if (workers.size() + 1 > elastic_.min_workers + blocked_.load(std::memory_order_acquire))
+      {
+        auto& w         = *workers.back();
+        auto  idleSince = clk_t::time_point(
+          clk_t::duration(w.idleSince.load(std::memory_order_relaxed)));
+        if (w.idle.load(std::memory_order_acquire) && now - idleSince >= elastic_.idle_timeout &&
+            w.idle.exchange(false, std::memory_order_acq_rel))
+        {
+          idle_.fetch_sub(1, std::memory_order_relaxed);
+          shrink();
+        }
+      }
+    }
+
+    auto
+    claim_idle() noexcept -> worker*
+    {
+      for (auto& w : running())
+      {
+        if (w->idle.load(std::memory_order_relaxed) &&
+            w->idle.exchange(false, std::memory_order_acq_rel))
+        {
+          idle_.fetch_sub(1, std::memory_order_relaxed);
+          return w.get();
+        }
+      }
+      return nullptr;
+    }
+
+    // Worker selection by the policy. Picking the last candidate (== nr of
+    // workers) means executing on the scheduler thread, except when elastic
+    // since a blocked scheduler can't balance. A worker standing in for the
+    // scheduler thread executes inline when picking itself (it's busy
+    // scheduling).
+    void
+    schedule(worker const* standIn = nullptr)
+    {
+      auto lock = std::unique_lock{schedulerMutex_};
+
+      auto const queues  = scheduled();
+      auto const version = scheduledVersion_;
+
+      auto const allowInline = !standIn && !elastic();
+      auto const candidates  = running().size() + (allowInline ? 1 : 0);
+      auto const first       = policy_.begin_pass(queues.size(), candidates);
+
+      if (queues.size() == 1 && allowInline)
+      {
+        if (auto range = split(*queues[0], queues[0]->queue.consume()); !range.empty())
+        {
+          auto const run = handoff(*queues[0], range);
+          lock.unlock();
+          executingInline_.fetch_add(1, std::memory_order_acq_rel);
+          (void)run();
+          executingInline_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+      }
+      else
+      {
+        for (std::size_t q = 0; q < queues.size(); ++q)
+        {
+          auto* e = queues[(first + q) % queues.size()];
+          if (auto range = split(*e, e->queue.consume()); !range.empty())
+          {
+            // assign (the rest) to picked (or preferred) worker
+            auto const workers = running();
+            auto const loadOf  = [workers](std::size_t i)
+            {
+              return load(workers, i);
+            };
+            auto const i = target(*e, policy_.pick(candidates, loadOf));
+            if (i < workers.size() && workers[i].get() != standIn) [[likely]]
+            {
+              worker& w = *workers[i];
+              auto    _ = details::trace_scope<>("dispatch", i);
+              stats_.dispatched.add();
+              THREADABLE_PROBE3(dispatch, &e->queue, i, range.size());
+              w.work.push(handoff(*e, range, &w));
+            }
+            else [[unlikely]]
+            {
+              // let helping threads keep scheduling meanwhile
+              auto const run = handoff(*e, range);
+              lock.unlock();
+              executingInline_.fetch_add(1, std::memory_order_acq_rel);
+              (void)run();
+              executingInline_.fetch_sub(1, std::memory_order_acq_rel);
+              lock.lock();
+              // 'scheduled_' is only refreshed by the next 'scheduled()', so
+              // check the queues themselves (a removed one might be gone)
+              if (queuesVersion_.load(std::memory_order_acquire) != version)
+              {
+                return;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // Executes some pending work on the calling thread. Safe to call from any
+    // thread, used when a thread executing jobs is waiting for a job to finish.
+    // Ranges of sequential queues are left alone: executed on top of the
+    // waiting job they might wait for it (or a job below it) to finish first.
+    auto
+    help() -> bool
+    {
+      // 1. Jobs spawned by this thread (most likely the children being waited on).
+      if (auto* job = details::this_thread_jobs().pop(); job)
+      {
+        (*job)();
+        stats_.helped.add();
+        return true;
+      }
+      // 2. Pending jobs in (parallel) queues.
+      if (auto lock = std::unique_lock{schedulerMutex_, std::try_to_lock}; lock)
+      {
+        for (auto* e : scheduled())
+        {
+          if (e->queue.policy() != execution_policy::parallel)
+          {
+            continue;
+          }
+          if (auto range = e->queue.consume(); !range.empty())
+          {
+            auto const run = handoff(*e, range);
+            lock.unlock();
+            stats_.helped.add(run());
+            return true;
+          }
+        }
+      }
+      // 3. Work already handed to (busy) workers.
+      for (auto& w : allocated())
+      {
+        if (auto lock = std::unique_lock{w->mutex, std::try_to_lock}; lock)
+        {
+          if (auto next = w->work.begin(); next == w->work.end() || !stealable(*next))
+          {
+            continue;
+          }
+          if (auto range = w->work.consume(1); !range.empty())
+          {
+            lock.unlock();
+            auto const n = w->work.execute(range);
+            w->stats.stolen.add(n);
+            stats_.helped.add(n);
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    // if a job pushed to a worker may execute on another thread (not a range
+    // of a sequential queue)
+    static auto
+    stealable(job const& job) noexcept -> bool
+    {
+      auto const* range = job.get().template target<range_handoff>();
+      return !range || range->owner->queue.policy() == execution_policy::parallel;
+    }
+
     alignas(details::cache_line_size) mutable std::mutex queueMutex_;
     alignas(details::cache_line_size) details::atomic_flag_t quit_;
     alignas(details::cache_line_size) queues_t queues_;
+    queues_t                                    removed_; // still being executed
+    std::atomic_size_t                          queuesVersion_{0};
     alignas(details::cache_line_size) std::thread scheduler_;
+    // sized to max workers up front & never reallocated, so it can be read while growing
     alignas(details::cache_line_size) std::vector<std::unique_ptr<worker>> workers_;
+    alignas(details::cache_line_size) std::atomic_size_t running_{0};
+    alignas(details::cache_line_size) std::atomic_size_t allocated_{0};
+    alignas(details::cache_line_size) std::atomic_size_t idle_{0};
+    alignas(details::cache_line_size) std::atomic_size_t nextWorker_{0};
+    alignas(details::cache_line_size) std::atomic_size_t blocked_{0};
+    alignas(details::cache_line_size) std::atomic_size_t executingInline_{0};
+    std::atomic_bool                                      standingIn_{false};
+
+    // resize state, shared with threads entering a blocking_region
+    alignas(details::cache_line_size) elasticity elastic_;
+    clk_t::time_point                             lastResize_;
+    std::mutex                                    resizeMutex_;
+    // scheduler state, shared with helping threads
+    alignas(details::cache_line_size) std::mutex schedulerMutex_;
+    policy_t                                      policy_;
+    std::vector<entry*>                           scheduled_;
+    std::size_t                                   scheduledVersion_ = 0;
+    bool                                          pendingRemoval_   = false;
+
+    [[no_unique_address]] details::pool_counters<> stats_;
+  };
+
+  // Marks a section where a job blocks (eg. on I/O or a lock held elsewhere),
+  // letting its pool start a compensation worker meanwhile so the remaining
+  // jobs keep the same number of threads busy. No-op outside of pool threads.
+  class blocking_region
+  {
+  public:
+    blocking_region() noexcept
+      : helper_(details::this_thread_helper)
+    {
+      if (helper_.block)
+      {
+        helper_.block(helper_.self, true);
+      }
+    }
+
+    blocking_region(blocking_region const&) = delete;
+    blocking_region(blocking_region&&)      = delete;
+
+    ~blocking_region()
+    {
+      if (helper_.block)
+      {
+        helper_.block(helper_.self, false);
+      }
+    }
+
+    auto operator=(blocking_region const&) -> blocking_region& = delete;
+    auto operator=(blocking_region&&) -> blocking_region&      = delete;
+
+  private:
+    details::wait_helper helper_;
   };
 
   namespace details
@@ -232,6 +1036,14 @@ namespace threadable
     return queue.push(FWD(func), FWD(args)...);
   }
 
+  template<std::copy_constructible callable_t, typename... arg_ts>
+  [[nodiscard]] inline auto
+  spawn(callable_t&& func, arg_ts&&... args) noexcept
+    requires requires (details::pool_t p) { p.spawn(FWD(func), FWD(args)...); }
+  {
+    return details::pool().spawn(FWD(func), FWD(args)...);
+  }
+
   [[nodiscard]] inline auto
   create(execution_policy policy = execution_policy::parallel) noexcept -> details::queue_t&
   {
@@ -0,0 +1,35 @@
+#pragma once
+
+// Linux USDT (static) probes, eg. for bpftrace:
+//
+//   bpftrace -e 'usdt:./app:threadable:push { @[arg0] = count(); }'
+//
+// Each probe is a single nop until attached to. Compiled out when
+// <sys/sdt.h> isn't available or THREADABLE_NO_PROBES is defined.
+//
+//   push        (queue*, slot, worker index)
+//   consume     (queue*, first slot, end slot)
+//   dispatch    (queue*, worker index, nr of jobs)
+//   job_begin   (queue*, slot, worker index)
+//   job_end     (queue*, slot, worker index)
+//   wait_enter  (job_token*, queue*, slot, worker index)
+//   wait_exit   (job_token*, queue*, slot, worker index)
+//
+// Slots are indices into the queue's job buffer (consume's are unmasked, ie.
+// they keep counting up). The worker index is that of the pool worker running
+// on the calling thread, -1 on other threads. Spawned jobs are waited on in
+// the thread's spawn buffer (queue*) instead.
+#if __has_include(<sys/sdt.h>) && !defined(THREADABLE_NO_PROBES)
+  #include <sys/sdt.h>
+  #define THREADABLE_PROBES                   1
+  #define THREADABLE_PROBE1(name, a)          DTRACE_PROBE1(threadable, name, a)
+  #define THREADABLE_PROBE2(name, a, b)       DTRACE_PROBE2(threadable, name, a, b)
+  #define THREADABLE_PROBE3(name, a, b, c)    DTRACE_PROBE3(threadable, name, a, b, c)
+  #define THREADABLE_PROBE4(name, a, b, c, d) DTRACE_PROBE4(threadable, name, a, b, c, d)
+#else
+  #define THREADABLE_PROBES                   0
+  #define THREADABLE_PROBE1(name, a)          ((void)0)
+  #define THREADABLE_PROBE2(name, a, b)       ((void)0)
+  #define THREADABLE_PROBE3(name, a, b, c)    ((void)0)
+  #define THREADABLE_PROBE4(name, a, b, c, d) ((void)0)
+#endif
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <threadable/allocator.hxx>
 #include <threadable/job.hxx>
+#include <threadable/local_queue.hxx>
+#include <threadable/probes.hxx>
+#include <threadable/stats.hxx>
+#include <threadable/trace.hxx>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 
 #if __has_include(<pstld/pstld.h>)
@@ -17,6 +24,7 @@
 #endif
 #include <iterator>
 #include <ranges>
+#include <thread>
 #include <vector>
 
 #define FWD(...) ::std::forward<decltype(__VA_ARGS__)>(__VA_ARGS__)
@@ -26,6 +34,32 @@ namespace threadable
   namespace details
   {
     constexpr std::size_t default_max_nr_of_jobs = 1 << 16;
+
+    // Time 'std::execution::par' takes to fork & join (measured once, best of
+    // a few runs with no-op jobs).
+    inline auto
+    parallel_overhead() -> std::chrono::nanoseconds
+    {
+      static auto const overhead = []
+      {
+        using clk_t = std::chrono::steady_clock;
+
+        auto nops = std::array<int, 2>{};
+        auto best = clk_t::duration::max();
+        for (int i = 0; i < 16; ++i)
+        {
+          auto const start = clk_t::now();
+          std::for_each(std::execution::par, std::begin(nops), std::end(nops),
+                        [](int& nop)
+                        {
+                          ++nop;
+                        });
+          best = std::min(best, clk_t::now() - start);
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(best);
+      }();
+      return overhead;
+    }
   }
 
   enum class execution_policy
@@ -34,13 +68,25 @@ namespace threadable
     parallel
   };
 
-  template<std::size_t max_nr_of_jobs = details::default_max_nr_of_jobs>
+  // Threads pushing to a queue (it's always consumed by one at a time).
+  enum class producer
+  {
+    multi, // any number, concurrently
+    single // one (at a time), pushing without read-modify-writes
+  };
+
+  template<std::size_t max_nr_of_jobs = details::default_max_nr_of_jobs,
+           producer producers         = producer::multi>
   class queue
   {
+    using clk_t                         = std::chrono::steady_clock;
     using atomic_index_t                = std::atomic_size_t;
     using index_t                       = typename atomic_index_t::value_type;
     static constexpr auto index_mask    = max_nr_of_jobs - 1u;
     static constexpr auto null_callback = [](queue&) {};
+    static constexpr auto commit_spins  = std::size_t{64};
+    // every n:th job (by slot) is timed for the cost estimate
+    static constexpr auto cost_sample_interval = std::size_t{16};
 
     static_assert(max_nr_of_jobs > 1, "number of jobs must be greater than 1");
     static_assert((max_nr_of_jobs & index_mask) == 0, "number of jobs must be a power of 2");
@@ -218,18 +264,23 @@ namespace threadable
     queue(queue const&) = delete;
     ~queue()            = default;
 
-    queue(execution_policy policy = execution_policy::parallel) noexcept
+    // 'pages::huge' backs the job slots by huge pages (if at least one)
+    queue(execution_policy policy = execution_policy::parallel,
+          pages            kind   = pages::normal) noexcept
       : policy_(policy)
+      , jobs_(max_nr_of_jobs, jobs_allocator_t(kind))
     {}
 
     queue(queue&& rhs) noexcept
       : policy_(std::move(rhs.policy_))
       , tail_(std::move(rhs.tail_))
+      , headCache_(rhs.headCache_)
       , head_(rhs.head_.load(std::memory_order::relaxed))
       , nextSlot_(rhs.nextSlot_.load(std::memory_order::relaxed))
       , jobs_(std::move(rhs.jobs_))
     {
-      rhs.tail_ = 0;
+      rhs.tail_      = 0;
+      rhs.headCache_ = 0;
       rhs.head_.store(0, std::memory_order::relaxed);
       rhs.nextSlot_.store(0, std::memory_order::relaxed);
     }
@@ -237,11 +288,12 @@ namespace threadable
     auto
     operator=(queue&& rhs) noexcept -> queue&
     {
-      tail_     = std::move(rhs.tail_);
-      head_     = rhs.head_.load(std::memory_order::relaxed);
-      nextSlot_ = rhs.nextSlot_.load(std::memory_order::relaxed);
-      policy_   = std::move(rhs.policy_);
-      jobs_     = std::move(rhs.jobs_);
+      tail_      = std::move(rhs.tail_);
+      headCache_ = rhs.headCache_;
+      head_      = rhs.head_.load(std::memory_order::relaxed);
+      nextSlot_  = rhs.nextSlot_.load(std::memory_order::relaxed);
+      policy_    = std::move(rhs.policy_);
+      jobs_      = std::move(rhs.jobs_);
       return *this;
     }
 
@@ -252,16 +304,18 @@ namespace threadable
     push(job_token& token, callable_t&& func, arg_ts&&... args) noexcept
     {
       // 1. Acquire a slot
-      index_t const slot = nextSlot_.fetch_add(1, std::memory_order_relaxed);
+      index_t const slot = acquire_slot();
 
       auto& job = jobs_[mask(slot)];
       assert(!job);
       if (job) [[unlikely]]
       {
+        stats_.fullStalls.add();
         details::wait<job_state::active, true>(job.state, std::memory_order_acquire);
       }
 
       // 2. Assign job
+      latency_.stamp(mask(slot));
       if constexpr (std::invocable<callable_t, job_token&, arg_ts...>)
       {
         job.set(FWD(func), std::ref(token), FWD(args)...);
@@ -273,17 +327,15 @@ namespace threadable
 
       assert(job);
 
-      token.reassign(job.state);
+      token.reassign(job.state, this, mask(slot));
 
       std::atomic_thread_fence(std::memory_order_release);
 
       // 3. Commit slot
-      index_t expected = slot;
-      while (!head_.compare_exchange_weak(expected, slot + 1, std::memory_order_relaxed))
-      {
-        expected = slot;
-      }
+      commit_slot(slot);
       head_.notify_all();
+      stats_.pushed.add();
+      THREADABLE_PROBE3(push, this, mask(slot), details::this_thread_worker);
     }
 
     template<std::copy_constructible callable_t, typename... arg_ts>
@@ -302,6 +354,7 @@ namespace threadable
       auto const head = nextSlot_.load(std::memory_order_acquire);
       if (mask(head - tail_) == 0)
       {
+        stats_.waits.add();
         head_.wait(head);
       }
     }
@@ -309,13 +362,29 @@ namespace threadable
     auto
     consume(std::size_t max = max_nr_of_jobs) noexcept
     {
-      auto head = head_.load(std::memory_order_acquire);
+      // only look at (the producers' cache line of) head if what's known to
+      // be committed doesn't cover the request
+      if (tail_ + max > headCache_)
+      {
+        headCache_ = head_.load(std::memory_order_acquire);
+      }
+      auto head = headCache_;
       auto b    = iterator(jobs_.data(), tail_);
       auto e    = iterator(nullptr, std::min(tail_ + max, head));
-      tail_     = head;
+      stats_.highWater.max(head - tail_);
+      THREADABLE_PROBE3(consume, this, tail_, e.index());
+      tail_ = e.index();
       return std::ranges::subrange(b, e);
     }
 
+    // A consumed range from its indices ('begin().index()' & 'end().index()'),
+    // eg. after handing those to another thread instead of the iterators.
+    auto
+    range(std::size_t first, std::size_t last) noexcept
+    {
+      return std::ranges::subrange(iterator(jobs_.data(), first), iterator(nullptr, last));
+    }
+
     void
     clear()
     {
@@ -325,7 +394,7 @@ namespace threadable
                     {
                       job.reset();
                     });
-      tail_ = head_.load(std::memory_order_acquire);
+      tail_ = headCache_ = head_.load(std::memory_order_acquire);
     }
 
     auto
@@ -345,26 +414,71 @@ namespace threadable
     execute(std::ranges::range auto r) const -> std::size_t
     {
       assert(r.data() >= jobs_.data() && r.data() <= jobs_.data() + jobs_.size());
-      if (policy_ == execution_policy::parallel) [[likely]]
+      auto const run = [this](job& job)
       {
-        std::for_each(std::execution::par, std::begin(r), std::end(r),
-                      [](job& job)
-                      {
-                        job();
-                      });
+        auto const slot = static_cast<std::size_t>(&job - jobs_.data());
+        auto _ = details::trace_scope<>("job", reinterpret_cast<std::uintptr_t>(this)); // NOLINT
+        THREADABLE_PROBE3(job_begin, this, slot, details::this_thread_worker);
+        if ((slot & (cost_sample_interval - 1)) == 0 ||
+            cost8Ns_.load(std::memory_order_relaxed) == 0) [[unlikely]]
+        {
+          auto const start = clk_t::now();
+          latency_.execute(slot, job);
+          record_cost(clk_t::now() - start);
+        }
+        else [[likely]]
+        {
+          latency_.execute(slot, job);
+        }
+        THREADABLE_PROBE3(job_end, this, slot, details::this_thread_worker);
+      };
+      if (policy_ == execution_policy::parallel && worth_parallel(r.size()))
+      {
+        if (auto const helper = details::this_thread_helper; helper) [[unlikely]]
+        {
+          // jobs might end up on other (eg. TBB) threads, so let them help out too
+          std::for_each(std::execution::par, std::begin(r), std::end(r),
+                        [helper, &run](job& job)
+                        {
+                          auto _ = details::scoped_wait_helper(helper);
+                          run(job);
+                          // run whatever the job spawned before moving on
+                          (void)details::this_thread_jobs().execute();
+                        });
+        }
+        else [[likely]]
+        {
+          std::for_each(std::execution::par, std::begin(r), std::end(r),
+                        [&run](job& job)
+                        {
+                          run(job);
+                        });
+        }
       }
-      else [[unlikely]]
+      else
       {
         auto b = std::begin(r);
-        // make sure previous has been executed
-        auto const& prev = *(b - 1);
-        details::wait<job_state::active, true>(prev.state, std::memory_order_acquire);
+        if (policy_ == execution_policy::sequential)
+        {
+          // make sure previous has been executed
+          auto const& prev = *(b - 1);
+          details::wait<job_state::active, true>(prev.state, std::memory_order_acquire);
+        }
+        else if (!r.empty())
+        {
+          stats_.inlined.add();
+        }
         std::for_each(b, std::end(r),
-                      [](job& job)
+                      [helper = details::this_thread_helper, &run](job& job)
                       {
-                        job();
+                        run(job);
+                        if (helper) [[unlikely]]
+                        {
+                          (void)details::this_thread_jobs().execute();
+                        }
                       });
       }
+      stats_.executed.add(r.size());
       return r.size();
     }
 
@@ -394,7 +508,119 @@ namespace threadable
       return size() == 0;
     }
 
+    auto
+    policy() const noexcept -> execution_policy
+    {
+      return policy_;
+    }
+
+    // Estimated execution time per job, a moving average of sampled jobs (the
+    // first & then every 'cost_sample_interval':th). Zero until known.
+    [[nodiscard]] auto
+    cost() const noexcept -> std::chrono::nanoseconds
+    {
+      return std::chrono::nanoseconds(cost8Ns_.load(std::memory_order_relaxed) / 8);
+    }
+
+    // all zero unless compiled with THREADABLE_STATS
+    [[nodiscard]] auto
+    stats() const noexcept -> queue_stats
+    {
+      return stats_.snapshot();
+    }
+
+    // empty unless compiled with THREADABLE_LATENCY
+    [[nodiscard]] auto
+    latency() const noexcept -> latency_stats
+    {
+      return latency_.snapshot();
+    }
+
+    // Bytes allocated by the queue, mostly job slots (in whole huge pages if
+    // backed by those). Callables too big for a job are allocated when pushed
+    // & not included.
+    [[nodiscard]] auto
+    memory_usage() const noexcept -> std::size_t
+    {
+      auto const slots = jobs_.capacity() * sizeof(job);
+      auto const paged = jobs_.get_allocator().page_kind() == pages::huge
+                           ? details::huge_pages_size(slots)
+                           : 0;
+      return sizeof(queue) + std::max(slots, paged) + latency_.memory_usage();
+    }
+
   private:
+    auto
+    acquire_slot() noexcept -> index_t
+    {
+      if constexpr (producers == producer::single)
+      {
+        auto const slot = nextSlot_.load(std::memory_order_relaxed);
+        nextSlot_.store(slot + 1, std::memory_order_relaxed);
+        return slot;
+      }
+      else
+      {
+        return nextSlot_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    // (after the job has been published)
+    void
+    commit_slot(index_t slot) noexcept
+    {
+      if constexpr (producers == producer::single)
+      {
+        head_.store(slot + 1, std::memory_order_relaxed);
+      }
+      else
+      {
+        // Slots are committed in order, so an earlier push that hasn't been
+        // committed yet holds this one up. If its producer was preempted,
+        // spinning just burns the timeslice it needs (and with more producers
+        // than cores every following push convoys behind it), so yield.
+        index_t expected = slot;
+        for (std::size_t spins = 0;
+             !head_.compare_exchange_weak(expected, slot + 1, std::memory_order_relaxed); ++spins)
+        {
+          expected = slot;
+          if (spins >= commit_spins) [[unlikely]]
+          {
+            if (spins == commit_spins)
+            {
+              stats_.commitYields.add();
+            }
+            std::this_thread::yield();
+          }
+        }
+      }
+    }
+
+    // Parallel execution pays off when the range is expected to take at least
+    // twice what forking & joining does. Until the cost is known it's assumed
+    // to.
+    auto
+    worth_parallel(std::size_t n) const noexcept -> bool
+    {
+      auto const costNs     = static_cast<std::size_t>(cost().count());
+      auto const overheadNs = static_cast<std::size_t>(details::parallel_overhead().count());
+      return n > 1 && (costNs == 0 || n * costNs >= 2 * overheadNs);
+    }
+
+    // Moves the average 1/8 towards 'elapsed'. It's kept scaled by 8 so the
+    // step doesn't truncate to nothing for short jobs, and updated with a CAS
+    // since several threads might sample jobs of this queue at once.
+    void
+    record_cost(clk_t::duration elapsed) const noexcept
+    {
+      auto const sample = std::max<std::size_t>(
+        static_cast<std::size_t>(std::chrono::nanoseconds(elapsed).count()), 1); // (0 = unknown)
+      auto prev = cost8Ns_.load(std::memory_order_relaxed);
+      while (!cost8Ns_.compare_exchange_weak(
+        prev, prev == 0 ? sample * 8 : prev - prev / 8 + sample, std::memory_order_relaxed))
+        ;
+    }
+
     /*
       Circular job buffer. When tail or head
       reaches the end they will wrap around:
@@ -413,10 +639,18 @@ namespace threadable
 
     alignas(details::cache_line_size) execution_policy policy_ = execution_policy::parallel;
     alignas(details::cache_line_size) index_t tail_{0};
+    index_t headCache_{0}; // last seen head (consumer side)
     alignas(details::cache_line_size) atomic_index_t head_{0};
     alignas(details::cache_line_size) atomic_index_t nextSlot_{0};
 
-    alignas(details::cache_line_size) std::vector<job> jobs_{max_nr_of_jobs};
+    using jobs_allocator_t = aligned_allocator<job, details::cache_line_size>;
+
+    alignas(details::cache_line_size) std::vector<job, jobs_allocator_t> jobs_;
+    // average job cost in eighths of a ns (written by whoever executes jobs,
+    // so kept off the line read on every push/pop)
+    alignas(details::cache_line_size) mutable std::atomic_size_t cost8Ns_{0};
+    [[no_unique_address]] mutable details::queue_counters<> stats_;
+    [[no_unique_address]] mutable details::latency_recorder<max_nr_of_jobs> latency_;
   };
 }
 
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <random>
+
+namespace threadable::scheduling
+{
+  // Load of a dispatch candidate, as seen by a policy. The scheduler thread
+  // (executing the range itself) may be offered as the last candidate & then
+  // reports maximal load, so load based policies only pick it as last resort.
+  struct load
+  {
+    std::size_t ranges  = 0; // pending in the worker's queue
+    std::size_t work_ns = 0; // estimated time to execute what's pending
+
+    static constexpr auto
+    max() noexcept -> load
+    {
+      return {std::numeric_limits<std::size_t>::max(), std::numeric_limits<std::size_t>::max()};
+    }
+  };
+
+  // least amount of (estimated) work split off a range to an idle worker,
+  // keeping the cost of dispatching & waking it up small in comparison
+  inline constexpr auto min_chunk = std::chrono::nanoseconds{20'000};
+
+  // Jobs per chunk worth at least 'min_chunk' (assuming 1ns per job when the
+  // cost isn't known yet).
+  inline auto
+  default_chunk(std::chrono::nanoseconds cost) noexcept -> std::size_t
+  {
+    return std::max<std::size_t>(
+      static_cast<std::size_t>(min_chunk / std::max(cost, std::chrono::nanoseconds{1})), 1);
+  }
+
+  /*
+    Decides where a pool's pending work goes. Called by one thread at a time
+    (the scheduler, or a thread standing in for it), once per scheduling pass:
+
+      begin_pass(queues, candidates) - returns the first queue to consume from
+                                       (the rest follow, wrapping around)
+      pick(candidates, load)         - who executes the next consumed range, an
+                                       index < 'candidates' ('load(index)' gives
+                                       its current load)
+      chunk(cost)                    - jobs per chunk split off a range to idle
+                                       workers, given the estimated cost per job
+                                       (0 = don't split)
+
+    Ranges of sequential queues are never split & those of queues with sticky
+    affinity go to their preferred worker when possible, regardless of policy.
+  */
+  template<typename policy_t>
+  concept policy = requires (policy_t p, std::size_t n, std::chrono::nanoseconds cost,
+                             load (*loadOf)(std::size_t)) {
+                     { p.begin_pass(n, n) } -> std::convertible_to<std::size_t>;
+                     { p.pick(n, loadOf) } -> std::convertible_to<std::size_t>;
+                     { p.chunk(cost) } -> std::convertible_to<std::size_t>;
+                   };
+
+  // A random candidate per range (the default).
+  class random
+  {
+  public:
+    static auto
+    begin_pass(std::size_t, std::size_t) noexcept -> std::size_t
+    {
+      return 0;
+    }
+
+    auto
+    pick(std::size_t candidates, auto const&) -> std::size_t
+    {
+      return distr_(gen_, param_t(0, candidates - 1));
+    }
+
+    static auto
+    chunk(std::chrono::nanoseconds cost) noexcept -> std::size_t
+    {
+      return default_chunk(cost);
+    }
+
+  private:
+    using param_t = std::uniform_int_distribution<std::size_t>::param_type;
+
+    std::mt19937                               gen_{std::random_device{}()};
+    std::uniform_int_distribution<std::size_t> distr_;
+  };
+
+  // The less busy (fewest ranges pending) of two distinct random candidates.
+  // Balances close to 'least_loaded' while only looking at two of them.
+  class power_of_two
+  {
+  public:
+    static auto
+    begin_pass(std::size_t, std::size_t) noexcept -> std::size_t
+    {
+      return 0;
+    }
+
+    auto
+    pick(std::size_t candidates, auto const& loadOf) -> std::size_t
+    {
+      if (candidates < 2) [[unlikely]]
+      {
+        return 0;
+      }
+      auto const first  = distr_(gen_, param_t(0, candidates - 1));
+      auto       second = distr_(gen_, param_t(0, candidates - 2));
+      if (second >= first) // skip 'first'
+      {
+        ++second;
+      }
+      return loadOf(second).ranges < loadOf(first).ranges ? second : first;
+    }
+
+    static auto
+    chunk(std::chrono::nanoseconds cost) noexcept -> std::size_t
+    {
+      return default_chunk(cost);
+    }
+
+  private:
+    using param_t = std::uniform_int_distribution<std::size_t>::param_type;
+
+    std::mt19937                               gen_{std::random_device{}()};
+    std::uniform_int_distribution<std::size_t> distr_;
+  };
+
+  // Candidates in turn, starting each pass at the next queue (so no queue is
+  // always consumed first).
+  class round_robin
+  {
+  public:
+    auto
+    begin_pass(std::size_t queues, std::size_t) noexcept -> std::size_t
+    {
+      return queues > 0 ? nextQueue_++ % queues : 0;
+    }
+
+    auto
+    pick(std::size_t candidates, auto const&) noexcept -> std::size_t
+    {
+      return nextWorker_++ % candidates;
+    }
+
+    static auto
+    chunk(std::chrono::nanoseconds cost) noexcept -> std::size_t
+    {
+      return default_chunk(cost);
+    }
+
+  private:
+    std::size_t nextQueue_  = 0;
+    std::size_t nextWorker_ = 0;
+  };
+
+  // The candidate with the least estimated work pending (fewest ranges on a
+  // tie). Looks at every candidate for every range.
+  class least_loaded
+  {
+  public:
+    static auto
+    begin_pass(std::size_t, std::size_t) noexcept -> std::size_t
+    {
+      return 0;
+    }
+
+    static auto
+    pick(std::size_t candidates, auto const& loadOf) -> std::size_t
+    {
+      std::size_t best     = 0;
+      auto        bestLoad = loadOf(0);
+      for (std::size_t i = 1; i < candidates; ++i)
+      {
+        if (auto const l = loadOf(i); l.work_ns < bestLoad.work_ns ||
+                                      (l.work_ns == bestLoad.work_ns && l.ranges < bestLoad.ranges))
+        {
+          best     = i;
+          bestLoad = l;
+        }
+      }
+      return best;
+    }
+
+    static auto
+    chunk(std::chrono::nanoseconds cost) noexcept -> std::size_t
+    {
+      return default_chunk(cost);
+    }
+  };
+
+  static_assert(policy<random>);
+  static_assert(policy<power_of_two>);
+  static_assert(policy<round_robin>);
+  static_assert(policy<least_loaded>);
+}
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <threadable/job.hxx>
+#include <threadable/queue.hxx>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#define FWD(...) ::std::forward<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace threadable
+{
+  /*
+    Job ring with the job states & bodies split in two arrays (structure of
+    arrays), for queues drained by one thread executing jobs in order:
+
+      states  [s|s|s|s|s|s|s|s|...]  one byte per job, 64 per cache line
+      bodies  [ body ][ body ]...    one cache line per job
+
+    Instead of an in-order commit (like 'queue'), a pushed job is published by
+    its state alone. The consumer finds ready jobs by scanning states a word
+    (8 states) at a time and only touches the bodies of jobs it executes, as
+    does 'clear()'. So producers never wait for each other.
+
+    A state tells which lap (of the ring) its job belongs to, so a job still
+    executing from the previous lap isn't taken for a newly pushed one.
+  */
+  template<std::size_t max_nr_of_jobs = details::default_max_nr_of_jobs>
+  class soa_queue
+  {
+    using index_t                              = std::size_t;
+    using word_t                               = std::uint64_t;
+    static constexpr auto         index_mask    = max_nr_of_jobs - 1u;
+    static constexpr auto         word_size     = sizeof(word_t);
+    static constexpr auto         line_size     = details::cache_line_size;
+    static constexpr std::uint8_t active_bit    = 1u << job_state::active;
+    static constexpr std::uint8_t lap_bit       = 1u << (job_state::active + 1);
+    static constexpr auto         ones          = ~word_t{0} / 0xff; // 0x0101...
+    static constexpr auto         scan_by_words = max_nr_of_jobs >= word_size;
+
+    static_assert(max_nr_of_jobs > 1, "number of jobs must be greater than 1");
+    static_assert((max_nr_of_jobs & index_mask) == 0, "number of jobs must be a power of 2");
+    static_assert(line_size % word_size == 0);
+
+    static constexpr auto
+    mask(index_t index) noexcept
+    {
+      return index & index_mask;
+    }
+
+    // state of a job pushed to slot 'index' (until executed)
+    static constexpr auto
+    ready_state(index_t index) noexcept -> std::uint8_t
+    {
+      return (index & max_nr_of_jobs) != 0 ? std::uint8_t{active_bit | lap_bit} : active_bit;
+    }
+
+  public:
+    using function_t = function<details::cache_line_size - sizeof(function<0>)>;
+
+    soa_queue() = default;
+
+    soa_queue(soa_queue const&) = delete;
+    soa_queue(soa_queue&&)      = delete;
+
+    ~soa_queue()
+    {
+      clear();
+    }
+
+    auto operator=(soa_queue const&) -> soa_queue& = delete;
+    auto operator=(soa_queue&&) -> soa_queue&      = delete;
+
+    template<std::copy_constructible callable_t, typename... arg_ts>
+      requires std::invocable<callable_t, arg_ts...> ||
+               std::invocable<callable_t, job_token&, arg_ts...>
+    void
+    push(job_token& token, callable_t&& func, arg_ts&&... args) noexcept
+    {
+      index_t const slot  = nextSlot_.fetch_add(1, std::memory_order_relaxed);
+      auto&         state = state_of(slot);
+      assert(!details::test<job_state::active>(state, std::memory_order_relaxed));
+      if (details::test<job_state::active>(state, std::memory_order_acquire)) [[unlikely]]
+      {
+        details::wait<job_state::active, true>(state, std::memory_order_acquire);
+      }
+
+      auto& body = bodies_[mask(slot)].func;
+      if constexpr (std::invocable<callable_t, job_token&, arg_ts...>)
+      {
+        body.set(FWD(func), std::ref(token), FWD(args)...);
+      }
+      else
+      {
+        body.set(FWD(func), FWD(args)...);
+      }
+      token.reassign(state, this, mask(slot));
+
+      // publish (wakes a consumer waiting for it)
+      state.store(ready_state(slot), std::memory_order_release);
+      details::atomic_notify_all(state);
+    }
+
+    template<std::copy_constructible callable_t, typename... arg_ts>
+      requires std::invocable<callable_t, arg_ts...>
+    auto
+    push(callable_t&& func, arg_ts&&... args) noexcept -> job_token
+    {
+      job_token token;
+      push(token, FWD(func), FWD(args)...);
+      return token;
+    }
+
+    // blocks until the next job is ready
+    void
+    wait() const noexcept
+    {
+      auto const& state    = state_of(tail_);
+      auto const  expected = ready_state(tail_);
+      for (auto current = state.load(std::memory_order_acquire); current != expected;
+           current      = state.load(std::memory_order_acquire))
+      {
+        state.wait(current, std::memory_order_acquire);
+      }
+    }
+
+    // executes (up to 'max') ready jobs in order, returns how many
+    auto
+    execute(std::size_t max = max_nr_of_jobs) -> std::size_t
+    {
+      auto const [first, last] = consume(max);
+      for (auto i = first; i != last; ++i)
+      {
+        auto& state = state_of(i);
+        // (synchronizes with the push, the scan doesn't)
+        (void)state.load(std::memory_order_acquire);
+        auto& body = bodies_[mask(i)].func;
+        body();
+        release(state, body);
+      }
+      return last - first;
+    }
+
+    // discards all ready jobs
+    void
+    clear() noexcept
+    {
+      auto const [first, last] = consume(max_nr_of_jobs);
+      for (auto i = first; i != last; ++i)
+      {
+        release(state_of(i), bodies_[mask(i)].func);
+      }
+    }
+
+    static constexpr auto
+    max_size() noexcept -> std::size_t
+    {
+      return max_nr_of_jobs - 1;
+    }
+
+    // pushed & not yet consumed (including jobs still being pushed)
+    auto
+    size() const noexcept -> std::size_t
+    {
+      return nextSlot_.load(std::memory_order_relaxed) - tail_;
+    }
+
+    auto
+    empty() const noexcept -> bool
+    {
+      return size() == 0;
+    }
+
+    // Jobs pushed & not yet executed (or cleared), counted from the states
+    // only.
+    [[nodiscard]] auto
+    pending() const noexcept -> std::size_t
+    {
+      std::size_t n = 0;
+      if constexpr (scan_by_words)
+      {
+        for (index_t i = 0; i < max_nr_of_jobs; i += word_size)
+        {
+          n += static_cast<std::size_t>(std::popcount(load_word(i) & (ones * active_bit)));
+        }
+      }
+      else
+      {
+        for (index_t i = 0; i < max_nr_of_jobs; ++i)
+        {
+          n += details::test<job_state::active>(state_of(i), std::memory_order_relaxed) ? 1 : 0;
+        }
+      }
+      return n;
+    }
+
+    // Bytes allocated by the queue. Callables too big for a job are allocated
+    // when pushed & not included.
+    [[nodiscard]] auto
+    memory_usage() const noexcept -> std::size_t
+    {
+      return sizeof(soa_queue) + lines_.capacity() * sizeof(state_line) +
+             bodies_.capacity() * sizeof(body_t);
+    }
+
+  private:
+    auto
+    state_of(index_t index) noexcept -> atomic_bitfield_t&
+    {
+      auto const slot = mask(index);
+      auto&      word = lines_[slot / line_size].words[slot % line_size / word_size];
+      return reinterpret_cast<atomic_bitfield_t*>(&word)[slot % word_size]; // NOLINT
+    }
+
+    auto
+    state_of(index_t index) const noexcept -> atomic_bitfield_t const&
+    {
+      auto const  slot = mask(index);
+      auto const& word = lines_[slot / line_size].words[slot % line_size / word_size];
+      return reinterpret_cast<atomic_bitfield_t const*>(&word)[slot % word_size]; // NOLINT
+    }
+
+    // The 8 states from 'index' (a multiple of 8). Only used to find
+    // candidates, what's acted upon is loaded again.
+    auto
+    load_word(index_t index) const noexcept -> word_t
+    {
+      auto const slot = mask(index);
+      assert(slot % word_size == 0);
+      return lines_[slot / line_size].words[slot % line_size / word_size].load(
+        std::memory_order_relaxed);
+    }
+
+    // index of the first byte set in 'word' (in memory order)
+    static auto
+    first_byte(word_t word) noexcept -> std::size_t
+    {
+      if constexpr (std::endian::native == std::endian::little)
+      {
+        return static_cast<std::size_t>(std::countr_zero(word)) / 8;
+      }
+      else
+      {
+        return static_cast<std::size_t>(std::countl_zero(word)) / 8;
+      }
+    }
+
+    // number of consecutive jobs from 'first' (up to 'max') that are ready
+    auto
+    ready(index_t first, std::size_t max) const noexcept -> std::size_t
+    {
+      std::size_t n = 0;
+      while (n < max)
+      {
+        auto const i = first + n;
+        if (scan_by_words && mask(i) % word_size == 0 && max - n >= word_size)
+        {
+          // (all 8 in the same lap since they don't wrap around)
+          if (auto const diff = load_word(i) ^ (ones * ready_state(i)); diff != 0)
+          {
+            return n + first_byte(diff);
+          }
+          n += word_size;
+        }
+        else if (state_of(i).load(std::memory_order_relaxed) == ready_state(i))
+        {
+          ++n;
+        }
+        else
+        {
+          break;
+        }
+      }
+      return n;
+    }
+
+    auto
+    consume(std::size_t max) noexcept -> std::pair<index_t, index_t>
+    {
+      auto const first = tail_;
+      tail_ += ready(first, std::min(max, max_nr_of_jobs));
+      return {first, tail_};
+    }
+
+    static void
+    release(atomic_bitfield_t& state, function_t& body) noexcept
+    {
+      body.reset();
+      details::clear(state, std::memory_order_release);
+      details::atomic_notify_all(state);
+    }
+
+    // States are stored as atomic words so a scan loads them atomically, while
+    // each job's state is accessed as an atomic byte within its word (it's what
+    // tokens wait on).
+    //
+    // NOTE: Mixing byte & word accesses to the same atomic object isn't covered
+    //       by the C++ memory model (so formally UB). It's relied upon here for
+    //       what the hardware gives on the targeted platforms (x86-64, AArch64):
+    //       naturally aligned byte & word accesses are each single-copy atomic
+    //       and lock-free, so a word load sees every byte as some value stored
+    //       to it. A scan only picks candidates, each job's state is loaded
+    //       again (as a byte, with acquire) before its body is touched.
+    struct alignas(details::cache_line_size) state_line
+    {
+      std::array<std::atomic<word_t>, line_size / word_size> words;
+    };
+
+    struct alignas(details::cache_line_size) body_t
+    {
+      function_t func;
+    };
+
+    static_assert(sizeof(state_line) == details::cache_line_size);
+    // (the assumptions above: no lock or padding in either atomic & words
+    // naturally aligned, as atomic_ref would require of them)
+    static_assert(sizeof(std::atomic<word_t>) == word_size &&
+                  std::atomic<word_t>::is_always_lock_free);
+    static_assert(alignof(std::atomic<word_t>) == word_size &&
+                  std::atomic_ref<word_t>::required_alignment == word_size &&
+                  std::atomic_ref<word_t>::is_always_lock_free);
+    static_assert(sizeof(atomic_bitfield_t) == 1 && atomic_bitfield_t::is_always_lock_free);
+    static_assert(std::atomic_ref<std::uint8_t>::required_alignment == 1 &&
+                  std::atomic_ref<std::uint8_t>::is_always_lock_free);
+    static_assert(sizeof(body_t) == details::cache_line_size);
+
+    alignas(details::cache_line_size) index_t tail_{0};
+    alignas(details::cache_line_size) std::atomic<index_t> nextSlot_{0};
+
+    std::vector<state_line> lines_{std::max<std::size_t>(max_nr_of_jobs / line_size, 1)};
+    std::vector<body_t>     bodies_{max_nr_of_jobs};
+  };
+}
+
+#undef FWD
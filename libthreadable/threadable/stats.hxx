@@ -0,0 +1,274 @@
+#pragma once
+
+#include <threadable/histogram.hxx>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace threadable
+{
+  namespace details
+  {
+    // THREADABLE_STATS (config.libthreadable.stats) collects statistics.
+    // Otherwise all counters are empty & compiled away (snapshots are all
+    // zero). Changes the layout of queues & pools, so it must be defined for
+    // the library & its users alike, as the build configuration does.
+#ifdef THREADABLE_STATS
+    inline constexpr bool stats_enabled = true;
+#else
+    inline constexpr bool stats_enabled = false;
+#endif
+    // THREADABLE_LATENCY (config.libthreadable.latency) timestamps jobs
+    // (push, start & end). Costs a few clock reads per job, so it's opt-in
+    // separately. Also changes the layout, like THREADABLE_STATS.
+#ifdef THREADABLE_LATENCY
+    inline constexpr bool latency_enabled = true;
+#else
+    inline constexpr bool latency_enabled = false;
+#endif
+
+    // Relaxed counter, readable from any thread while being updated.
+    template<bool enabled = stats_enabled>
+    struct counter
+    {
+      void
+      add(std::size_t n = 1) noexcept
+      {
+        value.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      void
+      max(std::size_t n) noexcept
+      {
+        auto prev = value.load(std::memory_order_relaxed);
+        while (prev < n && !value.compare_exchange_weak(prev, n, std::memory_order_relaxed))
+          ;
+      }
+
+      [[nodiscard]] auto
+      load() const noexcept -> std::size_t
+      {
+        return value.load(std::memory_order_relaxed);
+      }
+
+      std::atomic_size_t value{0};
+    };
+
+    template<>
+    struct counter<false>
+    {
+      void
+      add(std::size_t = 1) noexcept
+      {}
+
+      void
+      max(std::size_t) noexcept
+      {}
+
+      [[nodiscard]] auto
+      load() const noexcept -> std::size_t
+      {
+        return 0;
+      }
+    };
+  }
+
+  struct queue_stats
+  {
+    std::size_t pushed        = 0;
+    std::size_t executed      = 0;
+    std::size_t high_water    = 0; // max nr of jobs pending when consumed
+    std::size_t full_stalls   = 0; // pushes waiting for a slot to be executed
+    std::size_t waits         = 0; // consumer waits for jobs to be pushed
+    std::size_t inlined       = 0; // ranges (of a parallel queue) too small to parallelize
+    std::size_t commit_yields = 0; // pushes yielding to an earlier push not yet committed
+  };
+
+  struct worker_stats
+  {
+    std::size_t              executed = 0;
+    std::size_t              stolen   = 0; // executed by helping threads instead
+    std::size_t              wakeups  = 0;
+    std::chrono::nanoseconds busy{0};
+    std::chrono::nanoseconds idle{0};
+  };
+
+  struct latency_stats
+  {
+    histogram queued; // from push until execution starts
+    histogram run;    // execution time
+  };
+
+  struct pool_stats
+  {
+    std::size_t               scheduler_iterations = 0;
+    std::size_t               dispatched           = 0; // ranges handed to workers
+    std::size_t               helped               = 0; // jobs executed while waiting
+    std::vector<queue_stats>  queues;
+    std::vector<worker_stats> workers; // running workers only
+  };
+
+  namespace details
+  {
+    // Counters are plain members when enabled. When disabled they're static
+    // (stateless) so the owning struct is empty & takes no space.
+    template<bool enabled = stats_enabled>
+    struct queue_counters
+    {
+      counter<true> pushed;
+      counter<true> executed;
+      counter<true> highWater;
+      counter<true> fullStalls;
+      counter<true> waits;
+      counter<true> inlined;
+      counter<true> commitYields;
+
+      [[nodiscard]] auto
+      snapshot() const noexcept -> queue_stats
+      {
+        return {
+          .pushed        = pushed.load(),
+          .executed      = executed.load(),
+          .high_water    = highWater.load(),
+          .full_stalls   = fullStalls.load(),
+          .waits         = waits.load(),
+          .inlined       = inlined.load(),
+          .commit_yields = commitYields.load(),
+        };
+      }
+    };
+
+    template<>
+    struct queue_counters<false>
+    {
+      static inline counter<false> pushed, executed, highWater, fullStalls, waits; // NOLINT
+      static inline counter<false> inlined, commitYields;                          // NOLINT
+
+      [[nodiscard]] static auto
+      snapshot() noexcept -> queue_stats
+      {
+        return {};
+      }
+    };
+
+    template<bool enabled = stats_enabled>
+    struct worker_counters
+    {
+      counter<true> executed;
+      counter<true> stolen;
+      counter<true> wakeups;
+      counter<true> busyNs;
+      counter<true> idleNs;
+
+      [[nodiscard]] auto
+      snapshot() const noexcept -> worker_stats
+      {
+        return {
+          .executed = executed.load(),
+          .stolen   = stolen.load(),
+          .wakeups  = wakeups.load(),
+          .busy     = std::chrono::nanoseconds(busyNs.load()),
+          .idle     = std::chrono::nanoseconds(idleNs.load()),
+        };
+      }
+    };
+
+    template<>
+    struct worker_counters<false>
+    {
+      static inline counter<false> executed, stolen, wakeups, busyNs, idleNs; // NOLINT
+
+      [[nodiscard]] static auto
+      snapshot() noexcept -> worker_stats
+      {
+        return {};
+      }
+    };
+
+    template<bool enabled = stats_enabled>
+    struct pool_counters
+    {
+      counter<true> schedulerIterations;
+      counter<true> dispatched;
+      counter<true> helped;
+    };
+
+    template<>
+    struct pool_counters<false>
+    {
+      static inline counter<false> schedulerIterations, dispatched, helped; // NOLINT
+    };
+
+    // Push timestamps are kept beside the ring (indexed by slot) so 'job' stays
+    // the size of a cache line.
+    template<std::size_t slots, bool enabled = latency_enabled>
+    struct latency_recorder
+    {
+      using clk_t = std::chrono::steady_clock;
+
+      void
+      stamp(std::size_t slot) noexcept
+      {
+        pushedAt[slot] = clk_t::now().time_since_epoch().count();
+      }
+
+      template<typename job_t>
+      void
+      execute(std::size_t slot, job_t& job)
+      {
+        // read before executing, the slot is free for reuse after
+        auto const pushed = clk_t::time_point(clk_t::duration(pushedAt[slot]));
+        auto const start  = clk_t::now();
+        job();
+        auto const end = clk_t::now();
+        queued.record(start - pushed);
+        run.record(end - start);
+      }
+
+      [[nodiscard]] auto
+      snapshot() const noexcept -> latency_stats
+      {
+        return {.queued = queued.snapshot(), .run = run.snapshot()};
+      }
+
+      [[nodiscard]] auto
+      memory_usage() const noexcept -> std::size_t
+      {
+        return pushedAt.capacity() * sizeof(clk_t::rep);
+      }
+
+      std::vector<clk_t::rep> pushedAt = std::vector<clk_t::rep>(slots);
+      atomic_histogram        queued;
+      atomic_histogram        run;
+    };
+
+    template<std::size_t slots>
+    struct latency_recorder<slots, false>
+    {
+      void
+      stamp(std::size_t) noexcept
+      {}
+
+      template<typename job_t>
+      void
+      execute(std::size_t, job_t& job)
+      {
+        job();
+      }
+
+      [[nodiscard]] static auto
+      snapshot() noexcept -> latency_stats
+      {
+        return {};
+      }
+
+      [[nodiscard]] static auto
+      memory_usage() noexcept -> std::size_t
+      {
+        return 0;
+      }
+    };
+  }
+}
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <threadable/function.hxx>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace threadable
+{
+  namespace details
+  {
+    // THREADABLE_TRACE (config.libthreadable.trace) records a timeline of
+    // jobs & scheduler dispatches, written with 'threadable::write_trace()'.
+    // Changes what queues & pools execute, so like THREADABLE_STATS it must be
+    // defined for the library & its users alike.
+#ifdef THREADABLE_TRACE
+    inline constexpr bool trace_enabled = true;
+#else
+    inline constexpr bool trace_enabled = false;
+#endif
+
+    inline constexpr std::size_t trace_buffer_size = 1 << 15;
+
+    /*
+      Per-thread ring of the most recent events. Only the owning thread
+      writes, others read while it's written to (dropping events that are
+      being or have been overwritten meanwhile), so no locks on the hot path.
+      Each slot has a sequence number, odd while written, telling readers
+      which event it holds.
+    */
+    class trace_buffer
+    {
+      static constexpr auto index_mask = trace_buffer_size - 1u;
+
+      static_assert((trace_buffer_size & index_mask) == 0, "size must be a power of 2");
+
+    public:
+      struct event
+      {
+        char const*    name;
+        std::uintptr_t id;
+        std::int64_t   begin; // ns
+        std::int64_t   end;   // ns
+      };
+
+      explicit trace_buffer(std::size_t tid) noexcept
+        : tid_(tid)
+      {}
+
+      void
+      record(event const& e) noexcept
+      {
+        auto const head = head_.load(std::memory_order_relaxed);
+        auto&      slot = events_[head & index_mask];
+        slot.seq.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(e.name, std::memory_order_relaxed);
+        slot.id.store(e.id, std::memory_order_relaxed);
+        slot.begin.store(e.begin, std::memory_order_relaxed);
+        slot.end.store(e.end, std::memory_order_relaxed);
+        slot.seq.store(2 * head + 2, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_release);
+      }
+
+      [[nodiscard]] auto
+      events() const -> std::vector<event>
+      {
+        auto const head  = head_.load(std::memory_order_acquire);
+        auto const first = head > trace_buffer_size ? head - trace_buffer_size : 0;
+
+        std::vector<event> events;
+        events.reserve(head - first);
+        for (auto i = first; i < head; ++i)
+        {
+          auto const& slot = events_[i & index_mask];
+          auto const  seq  = 2 * i + 2;
+          if (slot.seq.load(std::memory_order_acquire) != seq)
+          {
+            continue;
+          }
+          auto const e = event{slot.name.load(std::memory_order_relaxed),
+                               slot.id.load(std::memory_order_relaxed),
+                               slot.begin.load(std::memory_order_relaxed),
+                               slot.end.load(std::memory_order_relaxed)};
+          // drop it if overwritten while copying
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (slot.seq.load(std::memory_order_relaxed) == seq)
+          {
+            events.push_back(e);
+          }
+        }
+        return events;
+      }
+
+      // Forgets all events & takes on another thread id, for reuse by a new
+      // thread. Requires no thread to be writing.
+      void
+      reset(std::size_t tid) noexcept
+      {
+        tid_ = tid;
+        name.clear();
+        head_.store(0, std::memory_order_release);
+      }
+
+      [[nodiscard]] auto
+      tid() const noexcept -> std::size_t
+      {
+        return tid_;
+      }
+
+      std::string name; // guarded by registry mutex
+
+    private:
+      struct slot
+      {
+        std::atomic_size_t          seq{0};
+        std::atomic<char const*>    name{nullptr};
+        std::atomic<std::uintptr_t> id{0};
+        std::atomic_int64_t         begin{0};
+        std::atomic_int64_t         end{0};
+      };
+
+      std::size_t                                tid_; // guarded by registry mutex
+      alignas(cache_line_size) std::atomic_size_t head_{0};
+      std::array<slot, trace_buffer_size>        events_;
+    };
+
+    /*
+      Buffers of running threads. When a thread exits, the events of its
+      buffer are kept until written (at most 'trace_buffer_size', dropping
+      the oldest) & the buffer is reused by the next thread to trace. So the
+      memory used is bounded by the number of threads running at once, no
+      matter how many come & go (eg. elastic workers).
+    */
+    struct trace_registry
+    {
+      struct retired_thread
+      {
+        std::size_t                      tid;
+        std::string                      name;
+        std::vector<trace_buffer::event> events;
+      };
+
+      auto
+      acquire() -> trace_buffer&
+      {
+        auto _   = std::scoped_lock{mutex};
+        auto tid = ++lastTid;
+        for (auto& e : buffers)
+        {
+          if (!e.used)
+          {
+            e.buffer->reset(tid);
+            e.used = true;
+            return *e.buffer;
+          }
+        }
+        return *buffers.emplace_back(std::make_unique<trace_buffer>(tid), true).buffer;
+      }
+
+      void
+      release(trace_buffer& buffer)
+      {
+        auto _      = std::scoped_lock{mutex};
+        auto events = buffer.events();
+        if (!events.empty())
+        {
+          retiredEvents += events.size();
+          retired.push_back({buffer.tid(), std::move(buffer.name), std::move(events)});
+        }
+        while (retiredEvents > trace_buffer_size)
+        {
+          auto& oldest = retired.front().events;
+          auto  drop   = std::min(oldest.size(), retiredEvents - trace_buffer_size);
+          oldest.erase(oldest.begin(), oldest.begin() + static_cast<std::ptrdiff_t>(drop));
+          retiredEvents -= drop;
+          if (oldest.empty())
+          {
+            retired.pop_front();
+          }
+        }
+        for (auto& e : buffers)
+        {
+          if (e.buffer.get() == &buffer)
+          {
+            e.used = false;
+          }
+        }
+      }
+
+      struct entry
+      {
+        std::unique_ptr<trace_buffer> buffer;
+        bool                          used; // by a running thread
+      };
+
+      std::mutex                 mutex;
+      std::vector<entry>         buffers;
+      std::deque<retired_thread> retired;
+      std::size_t                retiredEvents = 0;
+      std::size_t                lastTid       = 0;
+    };
+
+    inline auto
+    trace_buffers() -> trace_registry&
+    {
+      // never destroyed, threads (eg. TBB's) might exit after static destruction
+      static auto* registry = new trace_registry; // NOLINT
+      return *registry;
+    }
+
+    inline auto
+    this_thread_trace() -> trace_buffer&
+    {
+      struct owner
+      {
+        explicit owner(trace_buffer& buffer) noexcept
+          : buffer(buffer)
+        {}
+
+        owner(owner const&) = delete;
+        owner(owner&&)      = delete;
+
+        ~owner()
+        {
+          trace_buffers().release(buffer);
+        }
+
+        auto operator=(owner const&) -> owner& = delete;
+        auto operator=(owner&&) -> owner&      = delete;
+
+        trace_buffer& buffer;
+      };
+
+      thread_local owner const self{trace_buffers().acquire()};
+      return self.buffer;
+    }
+
+    inline auto
+    trace_now() noexcept -> std::int64_t
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+    }
+
+    // Records the lifetime of the scope as a complete event on this thread.
+    template<bool enabled = trace_enabled>
+    class trace_scope
+    {
+    public:
+      trace_scope(char const* name, std::uintptr_t id) noexcept
+        : name_(name)
+        , id_(id)
+        , begin_(trace_now())
+      {}
+
+      trace_scope(trace_scope const&) = delete;
+      trace_scope(trace_scope&&)      = delete;
+
+      ~trace_scope()
+      {
+        this_thread_trace().record({name_, id_, begin_, trace_now()});
+      }
+
+      auto operator=(trace_scope const&) -> trace_scope& = delete;
+      auto operator=(trace_scope&&) -> trace_scope&      = delete;
+
+    private:
+      char const*    name_;
+      std::uintptr_t id_;
+      std::int64_t   begin_;
+    };
+
+    template<>
+    class trace_scope<false>
+    {
+    public:
+      constexpr trace_scope(char const*, std::uintptr_t) noexcept
+      {}
+
+      // user-provided so (unused) scopes don't trigger warnings
+      ~trace_scope() {} // NOLINT
+    };
+
+    // microseconds with ns precision
+    inline void
+    write_trace_us(std::ostream& os, std::int64_t ns)
+    {
+      os << ns / 1000 << '.' << std::to_string(1000 + ns % 1000).substr(1);
+    }
+
+    // Name shown for the calling thread in the timeline.
+    inline void
+    trace_thread_name(std::string name)
+    {
+      if constexpr (trace_enabled)
+      {
+        auto& buffer   = this_thread_trace();
+        auto& registry = trace_buffers();
+        auto  _        = std::scoped_lock{registry.mutex};
+        buffer.name    = std::move(name);
+      }
+    }
+  }
+
+  // Writes recorded events (the most recent per thread) in Chrome trace-event
+  // JSON format, viewable in Perfetto or chrome://tracing. Job events have the
+  // queue address as id, dispatch events the worker index. Events of threads
+  // that have exited are only written once. Empty unless compiled with
+  // THREADABLE_TRACE.
+  inline void
+  write_trace(std::ostream& os)
+  {
+    os << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    if constexpr (details::trace_enabled)
+    {
+      auto& registry = details::trace_buffers();
+      auto  _        = std::scoped_lock{registry.mutex};
+      auto  first    = true;
+      auto  sep      = [&first, &os]() -> std::ostream&
+      {
+        os << (first ? "\n" : ",\n");
+        first = false;
+        return os;
+      };
+      auto const write = [&sep, &os](std::size_t tid, std::string const& name, auto const& events)
+      {
+        if (!name.empty())
+        {
+          sep() << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+                << R"(,"args":{"name":")" << name << R"("}})";
+        }
+        for (auto const& e : events)
+        {
+          sep() << R"({"name":")" << e.name << R"(","ph":"X","pid":1,"tid":)" << tid
+                << R"(,"ts":)";
+          details::write_trace_us(os, e.begin);
+          os << R"(,"dur":)";
+          details::write_trace_us(os, e.end - e.begin);
+          os << R"(,"args":{"id":)" << e.id << "}}";
+        }
+      };
+      // threads that have exited (forgotten once written)
+      for (auto const& thread : registry.retired)
+      {
+        write(thread.tid, thread.name, thread.events);
+      }
+      registry.retired.clear();
+      registry.retiredEvents = 0;
+      for (auto const& e : registry.buffers)
+      {
+        if (e.used)
+        {
+          write(e.buffer->tid(), e.buffer->name, e.buffer->events());
+        }
+      }
+    }
+    os << "\n]}\n";
+  }
+}